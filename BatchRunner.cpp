@@ -0,0 +1,392 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <glob.h>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "BatchRunner.hpp"
+#include "CarvingEngine.hpp"
+#include "Util/RunHelpers.hpp"
+#include "Util/ThreadPool.hpp"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+/** Carves a loaded image with a reusable engine.
+
+    Removes the job's vertical seams, followed by its
+    horizontal seams, then stores the carved pixel grid
+    back into the ImageLoader.
+ */
+template <typename P, typename Engine>
+void carveWith(Engine& engine, ImageLoader& loader, const BatchJob& job, unsigned int batch,
+               BatchResult& result) {
+  const FlexGrid<P> grid = loader.getGrid<P>();
+  result.inWidth = grid.getWidth();
+  result.inHeight = grid.getHeight();
+  if (job.vert >= grid.getWidth() || job.horiz >= grid.getHeight()) {
+    throw std::runtime_error("Cannot remove every column or row of the image!");
+  }
+
+  engine.reset(grid, CarvingMode::VERTICAL);
+  engine.removeSeams(job.vert, batch);
+  engine.setMode(CarvingMode::HORIZONTAL);
+  engine.removeSeams(job.horiz, batch);
+  loader.setGrid(engine.getGrid());
+}
+
+/** An image which has been read ahead of the workers.
+ */
+struct LoadedImage {
+  std::size_t index;
+  ImageLoader loader;
+  double loadSecs;
+  std::string error;
+};
+
+}
+
+/** Construct a new BatchRunner object.
+
+    @param workers
+    The number of images to carve at once, each on its own
+    worker thread.
+
+    @param threads
+    The number of threads each worker splits its energy and
+    cost grid calculations across.
+
+    @param batch
+    The maximum number of non-crossing seams to remove per
+    cost grid calculation.
+ */
+BatchRunner::BatchRunner(const unsigned int& workers, const unsigned int& threads, const unsigned int& batch) :
+  workers(std::max(1u, workers)),
+  threads(std::max(1u, threads)),
+  batch(std::max(1u, batch)),
+  overrideFormat(false),
+  format(PgmFormat::ASCII) { }
+
+/** Sets the format every output file is exported in.
+
+    Without an override, each output file keeps the format
+    of its input file.
+
+    @param format
+    The format to export in.
+ */
+void BatchRunner::setFormat(const PgmFormat& format) {
+  this->format = format;
+  overrideFormat = true;
+}
+
+/** Adds a single image to the batch.
+
+    @param job
+    The image to carve, and the seams to remove from it.
+ */
+void BatchRunner::addJob(const BatchJob& job) {
+  jobs.push_back(job);
+}
+
+/** Adds every image listed in a manifest file to the batch.
+
+    @param path
+    The path of the manifest, or "-" to read it from
+    standard input.
+ */
+void BatchRunner::loadManifest(const std::string& path) {
+  if (path == "-") {
+    loadManifest(std::cin);
+    return;
+  }
+
+  std::ifstream file(path);
+  if (!file) {
+    throw std::runtime_error("Unable to open " + path + "!");
+  }
+  loadManifest(file);
+}
+
+/** Adds every image listed in a manifest to the batch.
+
+    Every line of the manifest holds an input file, an output
+    file, and the number of vertical and horizontal seams to
+    remove, separated by whitespace. Blank lines, and lines
+    beginning with '#', are ignored.
+
+    @param in
+    The stream to read the manifest from.
+ */
+void BatchRunner::loadManifest(std::istream& in) {
+  std::string line;
+  for (unsigned int lineNum = 1; std::getline(in, line); ++lineNum) {
+    std::istringstream fields(line);
+
+    std::string first;
+    if (!(fields >> first) || first[0] == '#') {
+      continue;
+    }
+
+    BatchJob job;
+    job.input = first;
+    std::string extra;
+    long vert = -1;
+    long horiz = -1;
+    if (!(fields >> job.output >> vert >> horiz) || vert < 0 || horiz < 0 || (fields >> extra)) {
+      throw std::runtime_error("Malformed manifest line " + std::to_string(lineNum) + "!");
+    }
+    job.vert = vert;
+    job.horiz = horiz;
+    jobs.push_back(job);
+  }
+}
+
+/** Adds every image matching a glob pattern to the batch.
+
+    Each output file is named after its input file, as in the
+    single image mode. Files which are already the output of
+    a previous run, ending in "_processed.pgm", are skipped.
+
+    @param pattern
+    The glob pattern to match, such as "*.pgm" within a directory.
+
+    @param vert
+    The number of vertical seams to remove from each image.
+
+    @param horiz
+    The number of horizontal seams to remove from each image.
+ */
+void BatchRunner::addGlob(const std::string& pattern, const unsigned int& vert, const unsigned int& horiz) {
+  glob_t matches;
+  const int status = glob(pattern.c_str(), 0, nullptr, &matches);
+  if (status != 0 && status != GLOB_NOMATCH) {
+    globfree(&matches);
+    throw std::runtime_error("Unable to expand " + pattern + "!");
+  }
+
+  for (std::size_t i = 0; i < matches.gl_pathc; ++i) {
+    const std::string input = matches.gl_pathv[i];
+    if (endsWith(input, "_processed.pgm")) {
+      continue;
+    }
+    jobs.push_back(BatchJob{input, processedName(input), vert, horiz});
+  }
+  globfree(&matches);
+}
+
+/** Gets the number of images in the batch.
+
+    @returns the number of images.
+ */
+std::size_t BatchRunner::len() const {
+  return jobs.size();
+}
+
+/** Carves every image in the batch.
+
+    A reader thread loads images ahead of the workers, into a
+    queue holding at most one image per worker, so that reading
+    the next image overlaps with carving the current one. Each
+    worker keeps a single CarvingEngine for every image it
+    carves, so that its pixel, energy, cost and seam buffers
+    are only reallocated when an image outgrows them.
+
+    A failure only affects the image which caused it, and is
+    included in the report.
+
+    @param out
+    The stream to write the per image and aggregate
+    throughput report to.
+
+    @returns true if every image was carved successfully.
+ */
+bool BatchRunner::run(std::ostream& out) {
+  std::vector<BatchResult> results(jobs.size(), BatchResult());
+
+  std::mutex lock;
+  std::condition_variable loaded;
+  std::condition_variable taken;
+  std::deque<LoadedImage> queue;
+  bool reading = true;
+
+  const Clock::time_point start = Clock::now();
+
+  std::thread reader([&]() {
+    for (std::size_t i = 0; i < jobs.size(); ++i) {
+      LoadedImage image;
+      image.index = i;
+      const Clock::time_point from = Clock::now();
+      try {
+        image.loader.loadFile(jobs[i].input);
+      } catch (const std::exception& e) {
+        image.error = e.what();
+      }
+      image.loadSecs = secsBetween(from, Clock::now());
+
+      std::unique_lock<std::mutex> guard(lock);
+      taken.wait(guard, [&]() { return queue.size() < workers; });
+      queue.push_back(std::move(image));
+      loaded.notify_one();
+    }
+
+    std::lock_guard<std::mutex> guard(lock);
+    reading = false;
+    loaded.notify_all();
+  });
+
+  auto work = [&]() {
+    // One engine per pixel and cost type, each reusing its
+    // buffers between the images of its type
+    ThreadPool pool(threads);
+    CarvingEngine<std::uint8_t> narrow(pool);
+    CarvingEngine<std::uint8_t, std::uint16_t, std::uint64_t> narrowWide(pool);
+    CarvingEngine<std::uint16_t> wide(pool);
+    CarvingEngine<std::uint16_t, std::uint32_t, std::uint64_t> widest(pool);
+
+    for (;;) {
+      LoadedImage image;
+      {
+        std::unique_lock<std::mutex> guard(lock);
+        loaded.wait(guard, [&]() { return !queue.empty() || !reading; });
+        if (queue.empty()) {
+          return;
+        }
+        image = std::move(queue.front());
+        queue.pop_front();
+        taken.notify_one();
+      }
+
+      const BatchJob& job = jobs[image.index];
+      BatchResult& result = results[image.index];
+      result.loadSecs = image.loadSecs;
+      if (!image.error.empty()) {
+        result.error = image.error;
+        continue;
+      }
+
+      try {
+        const Clock::time_point from = Clock::now();
+        const int longest = std::max(image.loader.getWidth(), image.loader.getHeight());
+        if (!image.loader.isWide()) {
+          if (needsWideCost<std::uint8_t>(longest)) {
+            carveWith<std::uint8_t>(narrowWide, image.loader, job, batch, result);
+          } else {
+            carveWith<std::uint8_t>(narrow, image.loader, job, batch, result);
+          }
+        } else {
+          if (needsWideCost<std::uint16_t>(longest)) {
+            carveWith<std::uint16_t>(widest, image.loader, job, batch, result);
+          } else {
+            carveWith<std::uint16_t>(wide, image.loader, job, batch, result);
+          }
+        }
+        result.outWidth = result.inWidth - job.vert;
+        result.outHeight = result.inHeight - job.horiz;
+
+        const Clock::time_point carved = Clock::now();
+        result.carveSecs = secsBetween(from, carved);
+
+        if (overrideFormat) {
+          image.loader.setFormat(format);
+        }
+        image.loader.exportFile(job.output);
+        result.saveSecs = secsBetween(carved, Clock::now());
+        result.ok = true;
+      } catch (const std::exception& e) {
+        result.error = e.what();
+      }
+    }
+  };
+
+  std::vector<std::thread> pool;
+  for (unsigned int i = 1; i < workers; ++i) {
+    pool.emplace_back(work);
+  }
+  work();
+  for (auto& worker : pool) {
+    worker.join();
+  }
+  reader.join();
+
+  report(out, results, secsBetween(start, Clock::now()));
+  return std::all_of(results.begin(), results.end(), [](const BatchResult& r) { return r.ok; });
+}
+
+/** Writes the per image and aggregate throughput report.
+
+    Throughput is measured in megapixels of input image per
+    second, per image over the time spent loading, carving and
+    saving it, and in aggregate over the wall time of the batch.
+
+    @param out
+    The stream to write the report to.
+
+    @param results
+    The result of every image in the batch.
+
+    @param wallSecs
+    The wall time of the entire batch.
+ */
+void BatchRunner::report(std::ostream& out, const std::vector<BatchResult>& results, double wallSecs) const {
+  const std::ios::fmtflags flags = out.flags();
+  const std::streamsize precision = out.precision();
+  out << std::fixed << std::setprecision(2);
+
+  unsigned int carved = 0;
+  double megapixels = 0;
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const BatchResult& result = results[i];
+    out << jobs[i].input << " -> " << jobs[i].output << ": ";
+    if (!result.ok) {
+      out << "failed, " << result.error << std::endl;
+      continue;
+    }
+
+    const double pixels = static_cast<double>(result.inWidth) * result.inHeight / 1e6;
+    const double secs = result.loadSecs + result.carveSecs + result.saveSecs;
+    out << result.inWidth << "x" << result.inHeight << " -> "
+        << result.outWidth << "x" << result.outHeight
+        << ", load " << result.loadSecs * 1e3 << " ms"
+        << ", carve " << result.carveSecs * 1e3 << " ms"
+        << ", save " << result.saveSecs * 1e3 << " ms"
+        << ", " << (secs > 0 ? pixels / secs : 0) << " MPix/s" << std::endl;
+
+    ++carved;
+    megapixels += pixels;
+  }
+
+  out << carved << " of " << results.size() << " images carved, "
+      << megapixels << " MPix in " << wallSecs << " s: "
+      << (wallSecs > 0 ? megapixels / wallSecs : 0) << " MPix/s, "
+      << (wallSecs > 0 ? carved / wallSecs : 0) << " images/s" << std::endl;
+
+  out.flags(flags);
+  out.precision(precision);
+}
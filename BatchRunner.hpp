@@ -0,0 +1,73 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef BATCHRUNNER_HPP
+#define BATCHRUNNER_HPP
+
+#include <cstddef>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "ImageLoader.hpp"
+
+struct BatchJob {
+  std::string input;
+  std::string output;
+  unsigned int vert;
+  unsigned int horiz;
+};
+
+struct BatchResult {
+  bool ok;
+  std::string error;
+
+  int inWidth;
+  int inHeight;
+  int outWidth;
+  int outHeight;
+
+  double loadSecs;
+  double carveSecs;
+  double saveSecs;
+};
+
+class BatchRunner {
+  unsigned int workers;
+  unsigned int threads;
+  unsigned int batch;
+
+  bool overrideFormat;
+  PgmFormat format;
+
+  std::vector<BatchJob> jobs;
+public:
+  BatchRunner(const unsigned int&, const unsigned int&, const unsigned int&);
+
+  void setFormat(const PgmFormat&);
+
+  void addJob(const BatchJob&);
+  void loadManifest(const std::string&);
+  void loadManifest(std::istream&);
+  void addGlob(const std::string&, const unsigned int&, const unsigned int&);
+
+  std::size_t len() const;
+
+  bool run(std::ostream&);
+private:
+  void report(std::ostream&, const std::vector<BatchResult>&, double) const;
+};
+#endif
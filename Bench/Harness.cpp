@@ -0,0 +1,407 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "Harness.hpp"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+// Iteration counts grow until a run lasts at least the minimum
+// time, but never by more than this factor at once
+const double MAX_GROWTH = 10;
+const std::size_t MAX_ITERATIONS = 1000000000;
+
+/** Escapes a string for inclusion in JSON.
+
+    @param str
+    The string to escape.
+
+    @returns the quoted, escaped string.
+ */
+std::string quote(const std::string& str) {
+  std::string out = "\"";
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      out += '\\';
+    }
+    out += c;
+  }
+  return out + "\"";
+}
+
+/** Reads the value following a key of a flat JSON object.
+
+    @param object
+    The text of the object.
+
+    @param key
+    The key to look for.
+
+    @param val
+    Set to the raw text of the value, without quotes.
+
+    @returns true if the key was found.
+ */
+bool readField(const std::string& object, const std::string& key, std::string& val) {
+  std::size_t pos = object.find(quote(key));
+  if (pos == std::string::npos) {
+    return false;
+  }
+  pos = object.find(':', pos);
+  if (pos == std::string::npos) {
+    return false;
+  }
+  pos = object.find_first_not_of(" \t\r\n", pos + 1);
+  if (pos == std::string::npos) {
+    return false;
+  }
+  if (object[pos] == '"') {
+    const std::size_t end = object.find('"', pos + 1);
+    val = object.substr(pos + 1, end - pos - 1);
+  } else {
+    const std::size_t end = object.find_first_of(",}\r\n", pos);
+    val = object.substr(pos, end - pos);
+  }
+  return true;
+}
+
+}
+
+/** Construct a new BenchState object.
+
+    @param iterations
+    The number of iterations keepRunning allows.
+ */
+BenchState::BenchState(std::size_t iterations) :
+  iterations(iterations), done(0), paused(true), secs(0), items(0) { }
+
+/** Advances the benchmark loop by one iteration.
+
+    Timing starts with the first call, and stops once
+    every iteration has run.
+
+    @returns true while iterations remain.
+ */
+bool BenchState::keepRunning() {
+  if (done == 0) {
+    resumeTiming();
+  }
+  if (done == iterations) {
+    pauseTiming();
+    return false;
+  }
+  ++done;
+  return true;
+}
+
+/** Stops timing, so that per iteration setup is not measured.
+ */
+void BenchState::pauseTiming() {
+  if (!paused) {
+    secs += std::chrono::duration<double>(Clock::now() - started).count();
+    paused = true;
+  }
+}
+
+/** Resumes timing, after pauseTiming.
+ */
+void BenchState::resumeTiming() {
+  if (paused) {
+    started = Clock::now();
+    paused = false;
+  }
+}
+
+/** Sets the number of pixels processed by every iteration.
+
+    @param items
+    The number of pixels.
+ */
+void BenchState::setItemsPerIteration(double items) {
+  this->items = items;
+}
+
+/** Gets the number of iterations the benchmark runs.
+
+    @returns the number of iterations.
+ */
+std::size_t BenchState::getIterations() const {
+  return iterations;
+}
+
+/** Gets the time spent in timed iterations.
+
+    @returns the time in seconds.
+ */
+double BenchState::getSecs() const {
+  return secs;
+}
+
+/** Gets the number of pixels processed by every iteration.
+
+    @returns the number of pixels.
+ */
+double BenchState::getItems() const {
+  return items;
+}
+
+/** Construct a new BenchSuite object.
+
+    @param minSecs
+    The minimum time every benchmark must run for.
+
+    @param filter
+    Only benchmarks whose name contains the filter are run.
+ */
+BenchSuite::BenchSuite(double minSecs, const std::string& filter) :
+  minSecs(minSecs), filter(filter), rssReset(true) { }
+
+/** Checks whether a benchmark passes the suite's filter.
+
+    @param name
+    The name of the benchmark.
+
+    @returns true if the benchmark should run.
+ */
+bool BenchSuite::matches(const std::string& name) const {
+  return name.find(filter) != std::string::npos;
+}
+
+/** Runs a benchmark, recording and printing its result.
+
+    The benchmark is run with a growing number of iterations,
+    predicted from the previous run, until a run lasts at least
+    the minimum time. Only the final run is reported.
+
+    @param name
+    The name of the benchmark.
+
+    @param width
+    The width of the image benchmarked.
+
+    @param height
+    The height of the image benchmarked.
+
+    @param seams
+    The number of seams removed, or 0 if not applicable.
+
+    @param fn
+    The benchmark, which must loop while keepRunning
+    returns true.
+
+    @param out
+    The stream to print the result to.
+ */
+void BenchSuite::run(const std::string& name, unsigned int width, unsigned int height, unsigned int seams,
+                     const std::function<void(BenchState&)>& fn, std::ostream& out) {
+  if (!matches(name)) {
+    return;
+  }
+
+  rssReset = resetPeakRss() && rssReset;
+
+  std::size_t iterations = 1;
+  for (;;) {
+    BenchState state(iterations);
+    fn(state);
+
+    if (state.getSecs() >= minSecs || iterations >= MAX_ITERATIONS) {
+      const double pixels = state.getItems() > 0 ? state.getItems() : static_cast<double>(width) * height;
+
+      BenchResult result;
+      result.name = name;
+      result.width = width;
+      result.height = height;
+      result.seams = seams;
+      result.iterations = iterations;
+      result.nsPerIteration = state.getSecs() * 1e9 / iterations;
+      result.nsPerPixel = result.nsPerIteration / pixels;
+      result.mpixPerSec = pixels / result.nsPerIteration * 1e3;
+      result.peakRssKb = readPeakRss();
+      results.push_back(result);
+
+      const std::ios::fmtflags flags = out.flags();
+      out << std::left << std::setw(40) << name << std::right << std::fixed
+          << std::setw(12) << iterations
+          << std::setprecision(3) << std::setw(14) << result.nsPerIteration / 1e6 << " ms"
+          << std::setw(12) << result.nsPerPixel << " ns/px"
+          << std::setprecision(1) << std::setw(10) << result.mpixPerSec << " MPix/s"
+          << std::setw(10) << result.peakRssKb / 1024 << " MiB" << std::endl;
+      out.flags(flags);
+      return;
+    }
+
+    // Predict the iterations needed to reach the minimum time,
+    // with some headroom, as Google Benchmark does
+    const double perIteration = std::max(state.getSecs() / iterations, 1e-9);
+    const double wanted = minSecs * 1.4 / perIteration;
+    iterations = static_cast<std::size_t>(std::min(wanted, iterations * MAX_GROWTH));
+    iterations = std::min(std::max(iterations, state.getIterations() + 1), MAX_ITERATIONS);
+  }
+}
+
+/** Gets the result of every benchmark run so far.
+
+    @returns the results, in the order they were run.
+ */
+const std::vector<BenchResult>& BenchSuite::getResults() const {
+  return results;
+}
+
+/** Exports every result as JSON.
+
+    @param path
+    The path of the file to create.
+
+    @param context
+    Key value pairs describing the machine and build, such as
+    the SIMD level, exported alongside the results.
+ */
+void BenchSuite::exportJson(const std::string& path,
+                            const std::vector<std::pair<std::string, std::string>>& context) const {
+  std::ofstream out(path);
+  if (!out) {
+    throw std::runtime_error("Unable to open " + path + " for writing!");
+  }
+
+  out << "{\n  \"context\": {\n";
+  for (std::size_t i = 0; i < context.size(); ++i) {
+    out << "    " << quote(context[i].first) << ": " << quote(context[i].second) << ",\n";
+  }
+  out << "    \"peak_rss_per_benchmark\": " << (rssReset ? "true" : "false") << "\n  },\n";
+
+  out << "  \"benchmarks\": [\n" << std::setprecision(6);
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const BenchResult& r = results[i];
+    out << "    {\"name\": " << quote(r.name)
+        << ", \"width\": " << r.width
+        << ", \"height\": " << r.height
+        << ", \"seams\": " << r.seams
+        << ", \"iterations\": " << r.iterations
+        << ", \"ns_per_iteration\": " << r.nsPerIteration
+        << ", \"ns_per_pixel\": " << r.nsPerPixel
+        << ", \"mpix_per_sec\": " << r.mpixPerSec
+        << ", \"peak_rss_kb\": " << r.peakRssKb
+        << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+  }
+  out << "  ]\n}\n";
+
+  if (!out) {
+    throw std::runtime_error("Unable to write to file!");
+  }
+}
+
+/** Compares every result against a baseline JSON export.
+
+    Prints the change in time per pixel of every benchmark
+    present in both runs.
+
+    @param path
+    The path of a file written by exportJson.
+
+    @param tolerance
+    The largest allowed ratio of new to baseline time per
+    pixel, such as 1.1 to allow a 10% slowdown.
+
+    @param out
+    The stream to print the comparison to.
+
+    @returns true if no benchmark was slower than allowed.
+ */
+bool BenchSuite::compare(const std::string& path, double tolerance, std::ostream& out) const {
+  std::ifstream in(path);
+  if (!in) {
+    throw std::runtime_error("Unable to open " + path + "!");
+  }
+  std::stringstream text;
+  text << in.rdbuf();
+  const std::string json = text.str();
+
+  // Every benchmark is a flat object on its own line
+  std::map<std::string, double> baseline;
+  std::size_t pos = json.find("\"benchmarks\"");
+  while (pos != std::string::npos && (pos = json.find('{', pos)) != std::string::npos) {
+    const std::size_t end = json.find('}', pos);
+    const std::string object = json.substr(pos, end - pos + 1);
+    std::string name;
+    std::string nsPerPixel;
+    if (readField(object, "name", name) && readField(object, "ns_per_pixel", nsPerPixel)) {
+      baseline[name] = std::atof(nsPerPixel.c_str());
+    }
+    pos = end;
+  }
+
+  bool ok = true;
+  const std::ios::fmtflags flags = out.flags();
+  out << std::fixed << std::setprecision(3);
+  for (const BenchResult& r : results) {
+    const auto found = baseline.find(r.name);
+    if (found == baseline.end() || found->second <= 0) {
+      continue;
+    }
+    const double ratio = r.nsPerPixel / found->second;
+    const bool regressed = ratio > tolerance;
+    ok = ok && !regressed;
+    out << std::left << std::setw(40) << r.name << std::right
+        << std::setw(12) << found->second << " -> " << std::setw(10) << r.nsPerPixel << " ns/px"
+        << std::setw(10) << ratio << "x" << (regressed ? "  REGRESSED" : "") << std::endl;
+  }
+  out.flags(flags);
+  return ok;
+}
+
+/** Resets the peak resident set size of the process.
+
+    Relies upon Linux's clear_refs interface, without which the
+    reported peak covers the whole process lifetime.
+
+    @returns true if the peak was reset.
+ */
+bool BenchSuite::resetPeakRss() {
+  std::ofstream refs("/proc/self/clear_refs");
+  if (!refs) {
+    return false;
+  }
+  refs << "5";
+  refs.flush();
+  return static_cast<bool>(refs);
+}
+
+/** Reads the peak resident set size of the process.
+
+    @returns the peak size in KiB.
+ */
+long BenchSuite::readPeakRss() {
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line)) {
+    if (line.compare(0, 6, "VmHWM:") == 0) {
+      return std::atol(line.c_str() + 6);
+    }
+  }
+
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+}
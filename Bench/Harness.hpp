@@ -0,0 +1,81 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HARNESS_HPP
+#define HARNESS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+class BenchState {
+  typedef std::chrono::steady_clock Clock;
+
+  std::size_t iterations;
+  std::size_t done;
+  bool paused;
+  Clock::time_point started;
+  double secs;
+  double items;
+public:
+  explicit BenchState(std::size_t);
+
+  bool keepRunning();
+  void pauseTiming();
+  void resumeTiming();
+  void setItemsPerIteration(double);
+
+  std::size_t getIterations() const;
+  double getSecs() const;
+  double getItems() const;
+};
+
+struct BenchResult {
+  std::string name;
+  unsigned int width;
+  unsigned int height;
+  unsigned int seams;
+
+  std::size_t iterations;
+  double nsPerIteration;
+  double nsPerPixel;
+  double mpixPerSec;
+  long peakRssKb;
+};
+
+class BenchSuite {
+  double minSecs;
+  std::string filter;
+  bool rssReset;
+  std::vector<BenchResult> results;
+public:
+  BenchSuite(double, const std::string&);
+
+  bool matches(const std::string&) const;
+  void run(const std::string&, unsigned int, unsigned int, unsigned int,
+           const std::function<void(BenchState&)>&, std::ostream&);
+
+  const std::vector<BenchResult>& getResults() const;
+  void exportJson(const std::string&, const std::vector<std::pair<std::string, std::string>>&) const;
+  bool compare(const std::string&, double, std::ostream&) const;
+private:
+  static bool resetPeakRss();
+  static long readPeakRss();
+};
+#endif
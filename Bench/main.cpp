@@ -0,0 +1,496 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Harness.hpp"
+#include "../ImageLoader.hpp"
+#include "../Kernels.hpp"
+#include "../SeamCarver.hpp"
+#include "../Util/BufferedWriter.hpp"
+#include "../Util/FlexGrid.hpp"
+#include "../Util/ThreadPool.hpp"
+
+namespace {
+
+struct Size {
+  unsigned int width;
+  unsigned int height;
+};
+
+// Square sizes, followed by 4K and 8K UHD frames
+const Size SIZES[] = {
+  {256, 256}, {512, 512}, {1024, 1024}, {2048, 2048}, {3840, 2160}, {7680, 4320}
+};
+const unsigned int SEAM_COUNTS[] = {1, 16, 64};
+
+/** Generates a deterministic synthetic image.
+
+    Combines smooth gradients, a few solid shapes, and
+    noise from a fixed seed, so that seams have both
+    cheap and expensive regions to choose between.
+
+    @param width
+    The width of the image.
+
+    @param height
+    The height of the image.
+
+    @returns the 8 bit pixel grid.
+ */
+FlexGrid<std::uint8_t> makeImage(unsigned int width, unsigned int height) {
+  FlexGrid<std::uint8_t> grid(width, height);
+  unsigned int seed = 12345;
+  for (unsigned int h = 0; h < height; ++h) {
+    std::uint8_t* row = grid.row(h);
+    for (unsigned int w = 0; w < width; ++w) {
+      seed = seed * 1103515245 + 12345;
+      int val = static_cast<int>((w * 80) / width + (h * 48) / height);
+      const unsigned int cx = w * 8 / width;
+      const unsigned int cy = h * 8 / height;
+      if ((cx + cy) % 3 == 0) {
+        val += 80;
+      }
+      val += (seed >> 16) % 24;
+      row[w] = val;
+    }
+  }
+  return grid;
+}
+
+/** Writes a pixel grid as a PGM file, without an ImageLoader.
+
+    @param grid
+    The 8 bit pixel grid to write.
+
+    @param path
+    The path of the file to create.
+
+    @param binary
+    true for P5, false for P2.
+ */
+void writePgm(const FlexGrid<std::uint8_t>& grid, const std::string& path, bool binary) {
+  BufferedWriter out(path);
+  out.putStr(binary ? "P5\n" : "P2\n");
+  out.putUInt(grid.getWidth());
+  out.put(' ');
+  out.putUInt(grid.getHeight());
+  out.putStr("\n255\n");
+  for (unsigned int h = 0; h < grid.getHeight(); ++h) {
+    const std::uint8_t* row = grid.row(h);
+    for (unsigned int w = 0; w < grid.getWidth(); ++w) {
+      if (binary) {
+        out.put(static_cast<char>(row[w]));
+      } else {
+        out.putUInt(row[w]);
+        out.put(w + 1 < grid.getWidth() ? ' ' : '\n');
+      }
+    }
+  }
+  out.close();
+}
+
+/** Runs every benchmark for a single image size.
+
+    The image is generated before, and freed after, the
+    benchmarks of its size, so that the peak memory of each
+    benchmark only includes one image.
+ */
+void runSize(BenchSuite& suite, const Size& size, ThreadPool& pool, const std::string& tmp) {
+  const unsigned int width = size.width;
+  const unsigned int height = size.height;
+  const std::string dims = std::to_string(width) + "x" + std::to_string(height);
+  const FlexGrid<std::uint8_t> grid = makeImage(width, height);
+
+  suite.run("calcEnergy/" + dims, width, height, 0, [&](BenchState& state) {
+    while (state.keepRunning()) {
+      FlexGrid<std::uint16_t> energy = calcEnergy(grid, pool);
+    }
+  }, std::cout);
+
+  const FlexGrid<std::uint16_t> energy = calcEnergy(grid);
+  suite.run("calcCostV/" + dims, width, height, 0, [&](BenchState& state) {
+    while (state.keepRunning()) {
+      FlexGrid<std::uint32_t> cost = calcCost(energy, CarvingMode::VERTICAL, pool);
+    }
+  }, std::cout);
+  suite.run("calcCostH/" + dims, width, height, 0, [&](BenchState& state) {
+    while (state.keepRunning()) {
+      FlexGrid<std::uint32_t> cost = calcCost(energy, CarvingMode::HORIZONTAL, pool);
+    }
+  }, std::cout);
+
+  // Energy and cost in a single pass, without an energy grid
+  suite.run("calcCostFused/gradient/" + dims, width, height, 0, [&](BenchState& state) {
+    FlexGrid<std::uint32_t> cost(0, 0);
+    while (state.keepRunning()) {
+      calcCostFused<GradientEnergy>(grid, cost, pool);
+    }
+  }, std::cout);
+  suite.run("calcCostFused/sobel/" + dims, width, height, 0, [&](BenchState& state) {
+    FlexGrid<std::uint32_t> cost(0, 0);
+    while (state.keepRunning()) {
+      calcCostFused<SobelEnergy>(grid, cost, pool);
+    }
+  }, std::cout);
+  suite.run("calcCostFused/forward/" + dims, width, height, 0, [&](BenchState& state) {
+    FlexGrid<std::uint32_t> cost(0, 0);
+    while (state.keepRunning()) {
+      calcCostFused<ForwardEnergy>(grid, cost, pool);
+    }
+  }, std::cout);
+
+  // Seam removal shrinks the grid, so every iteration
+  // starts from an untimed copy
+  const CarvingMode modes[] = {CarvingMode::VERTICAL, CarvingMode::HORIZONTAL};
+  for (const CarvingMode& mode : modes) {
+    const std::string name = mode == CarvingMode::VERTICAL ? "traceBackRemV/" : "traceBackRemH/";
+    if (!suite.matches(name + dims)) {
+      continue;
+    }
+    const FlexGrid<std::uint32_t> cost = calcCost(energy, mode, pool);
+    FlexGrid<std::uint8_t> work(0, 0);
+    suite.run(name + dims, width, height, 0, [&](BenchState& state) {
+      while (state.keepRunning()) {
+        state.pauseTiming();
+        work.assign(grid);
+        state.resumeTiming();
+        traceBackRem(work, cost, mode);
+      }
+    }, std::cout);
+  }
+
+  for (const unsigned int& seams : SEAM_COUNTS) {
+    suite.run("seamCarve/" + dims + "/" + std::to_string(seams), width, height, seams, [&](BenchState& state) {
+      while (state.keepRunning()) {
+        FlexGrid<std::uint8_t> carved = seamCarve(grid, CarvingMode::VERTICAL, seams, pool);
+      }
+    }, std::cout);
+  }
+
+  for (const unsigned int& seams : SEAM_COUNTS) {
+    suite.run("seamCarvePyramid/" + dims + "/" + std::to_string(seams), width, height, seams,
+              [&](BenchState& state) {
+      while (state.keepRunning()) {
+        FlexGrid<std::uint8_t> carved = seamCarve(grid, CarvingMode::VERTICAL, seams, pool, 1,
+                                                  SearchMode::PYRAMID, 2);
+      }
+    }, std::cout);
+  }
+
+  const EnergyKind energies[] = {EnergyKind::SOBEL, EnergyKind::FORWARD};
+  for (const EnergyKind& energy : energies) {
+    const std::string name = energy == EnergyKind::SOBEL ? "seamCarveSobel/" : "seamCarveForward/";
+    for (const unsigned int& seams : SEAM_COUNTS) {
+      suite.run(name + dims + "/" + std::to_string(seams), width, height, seams, [&](BenchState& state) {
+        while (state.keepRunning()) {
+          FlexGrid<std::uint8_t> carved = seamCarve(grid, CarvingMode::VERTICAL, seams, pool, energy);
+        }
+      }, std::cout);
+    }
+  }
+
+  const bool formats[] = {true, false};
+  for (const bool& binary : formats) {
+    const std::string ext = binary ? "p5" : "p2";
+    const std::string loadName = "ImageLoader/load/" + ext + "/" + dims;
+    const std::string exportName = "ImageLoader/export/" + ext + "/" + dims;
+    if (!suite.matches(loadName) && !suite.matches(exportName)) {
+      continue;
+    }
+
+    const std::string path = tmp + "/SeamCarvingBench_" + dims + "." + ext + ".pgm";
+    const std::string outPath = tmp + "/SeamCarvingBench_" + dims + "." + ext + "_processed.pgm";
+    writePgm(grid, path, binary);
+
+    suite.run(loadName, width, height, 0, [&](BenchState& state) {
+      while (state.keepRunning()) {
+        ImageLoader loader;
+        loader.loadFile(path);
+      }
+    }, std::cout);
+
+    ImageLoader loader;
+    loader.loadFile(path);
+    suite.run(exportName, width, height, 0, [&](BenchState& state) {
+      while (state.keepRunning()) {
+        loader.exportFile(outPath);
+      }
+    }, std::cout);
+
+    std::remove(path.c_str());
+    std::remove(outPath.c_str());
+  }
+}
+
+/** Gets the name of a SIMD level.
+ */
+std::string simdName(const SimdLevel& level) {
+  switch (level) {
+    case SimdLevel::SCALAR:
+      return "scalar";
+    case SimdLevel::SSE2:
+      return "sse2";
+    case SimdLevel::AVX2:
+      return "avx2";
+  }
+  return "unknown";
+}
+
+/** Fills a buffer with values from a fixed seed.
+
+    Every fourth value is 0 or the largest value, so that
+    kernels are checked at both ends of their range.
+
+    @param values
+    The buffer to fill.
+
+    @param max
+    The largest value to fill with.
+
+    @param seed
+    The state of the generator, advanced by every value.
+ */
+template <typename T>
+  void fillValues(std::vector<T>& values, std::uint64_t max, unsigned int& seed) {
+    for (T& value : values) {
+      seed = seed * 1103515245 + 12345;
+      const unsigned int pick = (seed >> 8) & 0xFFFF;
+      if (pick % 8 == 0) {
+        value = 0;
+      } else if (pick % 8 == 1) {
+        value = static_cast<T>(max);
+      } else {
+        value = static_cast<T>((static_cast<std::uint64_t>(seed >> 4) * 2654435761u) % (max + 1));
+      }
+    }
+  }
+
+/** Compares energyRow against energyRowScalar for one pixel type.
+
+    Rows start both on and off alignment, so that vector loads
+    straddling cache lines and the scalar tails are covered.
+
+    @param widths
+    The row widths to check.
+
+    @param max
+    The largest pixel value.
+
+    @returns the number of mismatching rows.
+ */
+template <typename P, typename E>
+  unsigned int verifyEnergy(const std::vector<unsigned int>& widths, std::uint64_t max) {
+    unsigned int seed = 4321;
+    unsigned int failures = 0;
+    for (unsigned int width : widths) {
+      for (unsigned int offset = 0; offset < 2; ++offset) {
+        std::vector<P> up(width + offset), cur(width + offset), down(width + offset);
+        fillValues(up, max, seed);
+        fillValues(cur, max, seed);
+        fillValues(down, max, seed);
+
+        std::vector<E> fast(width + offset), slow(width + offset);
+        energyRow(up.data() + offset, cur.data() + offset, down.data() + offset, fast.data() + offset, width);
+        energyRowScalar(up.data() + offset, cur.data() + offset, down.data() + offset, slow.data() + offset, width);
+        if (fast != slow) {
+          ++failures;
+        }
+      }
+    }
+    return failures;
+  }
+
+/** Compares costRow against costRowScalar for one energy type.
+
+    Runs are checked with every combination of edge flags, the
+    previous row holding a cell either side of the run for the
+    flags which read beyond it.
+
+    @param widths
+    The run lengths to check.
+
+    @param max
+    The largest energy value.
+
+    @returns the number of mismatching runs.
+ */
+template <typename E, typename C>
+  unsigned int verifyCost(const std::vector<unsigned int>& widths, std::uint64_t max) {
+    unsigned int seed = 8765;
+    unsigned int failures = 0;
+    for (unsigned int width : widths) {
+      for (unsigned int edges = 0; edges < 4; ++edges) {
+        const bool leftEdge = (edges & 1) != 0;
+        const bool rightEdge = (edges & 2) != 0;
+
+        std::vector<E> energy(width);
+        std::vector<C> prev(width + 2);
+        fillValues(energy, max, seed);
+        // Keep every sum within the cost type
+        fillValues(prev, std::numeric_limits<C>::max() / 2, seed);
+
+        std::vector<C> fast(width), slow(width);
+        costRow(energy.data(), prev.data() + 1, fast.data(), width, leftEdge, rightEdge);
+        costRowScalar(energy.data(), prev.data() + 1, slow.data(), width, leftEdge, rightEdge);
+        if (fast != slow) {
+          ++failures;
+        }
+      }
+    }
+    return failures;
+  }
+
+/** Checks every vectorized kernel against its scalar reference.
+
+    Runs every kernel at every SIMD level the CPU supports,
+    across widths around each vector width, and reports the
+    number of mismatches per level.
+
+    @param out
+    The stream to report to.
+
+    @returns true if every kernel matched its reference exactly.
+ */
+bool verifyKernels(std::ostream& out) {
+  std::vector<unsigned int> widths;
+  for (unsigned int width = 1; width <= 80; ++width) {
+    widths.push_back(width);
+  }
+  for (unsigned int width : {127u, 128u, 129u, 255u, 256u, 257u, 1023u, 1024u, 1025u, 4099u}) {
+    widths.push_back(width);
+  }
+
+  const SimdLevel initial = getSimdLevel();
+  const SimdLevel supported = getSupportedSimdLevel();
+  bool ok = true;
+  for (SimdLevel level : {SimdLevel::SCALAR, SimdLevel::SSE2, SimdLevel::AVX2}) {
+    if (static_cast<int>(level) > static_cast<int>(supported)) {
+      out << simdName(level) << ": not supported by this CPU" << std::endl;
+      continue;
+    }
+    setSimdLevel(level);
+
+    unsigned int failures = 0;
+    failures += verifyEnergy<std::uint8_t, std::uint16_t>(widths, 255);
+    failures += verifyEnergy<std::uint16_t, std::uint32_t>(widths, 65535);
+    failures += verifyEnergy<std::int32_t, std::int32_t>(widths, 1 << 20);
+    failures += verifyCost<std::uint16_t, std::uint32_t>(widths, 4 * 255);
+    failures += verifyCost<std::uint32_t, std::uint32_t>(widths, 4 * 65535);
+    failures += verifyCost<std::int32_t, std::int32_t>(widths, 1 << 22);
+    out << simdName(level) << ": " << (failures == 0 ? "ok" : std::to_string(failures) + " mismatches")
+        << std::endl;
+    ok = ok && failures == 0;
+  }
+  setSimdLevel(initial);
+  return ok;
+}
+}
+
+int main(int argc, char* argv[]) {
+  double minSecs = 0.5;
+  double tolerance = 1.1;
+  unsigned int threads = 1;
+  unsigned int maxSize = 0;
+  std::string filter;
+  std::string json;
+  std::string baseline;
+  std::string tmp = "/tmp";
+  bool verify = false;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "--verify") {
+      verify = true;
+      continue;
+    }
+    if (i + 1 >= argc) {
+      throw std::runtime_error("Missing value for " + arg + "!");
+    }
+    const std::string val = argv[++i];
+    if (arg == "--min-time") {
+      minSecs = std::atof(val.c_str());
+    } else if (arg == "--filter") {
+      filter = val;
+    } else if (arg == "--threads") {
+      // A thread count of 0 uses every available core
+      threads = std::atoi(val.c_str());
+      if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+      }
+    } else if (arg == "--max-size") {
+      maxSize = std::atoi(val.c_str());
+    } else if (arg == "--json") {
+      json = val;
+    } else if (arg == "--compare") {
+      baseline = val;
+    } else if (arg == "--tolerance") {
+      tolerance = std::atof(val.c_str());
+    } else if (arg == "--tmp") {
+      tmp = val;
+    } else if (arg == "--simd") {
+      setSimdLevel(val == "scalar" ? SimdLevel::SCALAR : (val == "sse2" ? SimdLevel::SSE2 : SimdLevel::AVX2));
+    } else {
+      throw std::runtime_error("Unknown option " + arg + "!");
+    }
+  }
+
+  // Check the kernels instead of timing anything
+  if (verify) {
+    return verifyKernels(std::cout) ? 0 : 1;
+  }
+
+  ThreadPool pool(threads);
+  BenchSuite suite(minSecs, filter);
+  std::cout << "SIMD level " << simdName(getSimdLevel()) << ", " << threads << " thread(s)" << std::endl;
+  std::cout << std::left << std::setw(40) << "Benchmark" << std::right << std::setw(12) << "Iterations"
+            << std::setw(17) << "Time" << std::setw(18) << "Per Pixel" << std::setw(17) << "Throughput"
+            << std::setw(14) << "Peak RSS" << std::endl;
+  for (const Size& size : SIZES) {
+    if (maxSize == 0 || std::max(size.width, size.height) <= maxSize) {
+      runSize(suite, size, pool, tmp);
+    }
+  }
+
+  if (!json.empty()) {
+    char date[32];
+    const std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+
+    std::vector<std::pair<std::string, std::string>> context;
+    context.emplace_back("date", date);
+    context.emplace_back("simd_level", simdName(getSimdLevel()));
+    context.emplace_back("threads", std::to_string(threads));
+    context.emplace_back("hardware_threads", std::to_string(std::thread::hardware_concurrency()));
+    context.emplace_back("min_time", std::to_string(minSecs));
+    suite.exportJson(json, context);
+  }
+
+  if (!baseline.empty()) {
+    std::cout << std::endl << "Compared to " << baseline << ":" << std::endl;
+    return suite.compare(baseline, tolerance, std::cout) ? 0 : 1;
+  }
+  return 0;
+}
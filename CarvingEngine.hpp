@@ -0,0 +1,142 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef CARVINGENGINE_HPP
+#define CARVINGENGINE_HPP
+
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "SeamCarver.hpp"
+#include "Util/FlexGrid.hpp"
+
+template <typename P, typename E, typename C>
+class CarvingEngine {
+  CarvingMode mode;
+  ThreadPool* pool;
+  FlexGrid<P> grid;
+  FlexGrid<P> spare;
+  FlexGrid<E> energy;
+  FlexGrid<C> cost;
+  std::vector<unsigned int> seam;
+
+  std::vector<unsigned int> batchSeams;
+  std::vector<unsigned char> used;
+
+  std::size_t coneCells;
+  unsigned int sinceMeasured;
+  double removedEnergy;
+  unsigned int carvedSeams;
+
+  bool tracking;
+  unsigned int removedSeams;
+  FlexGrid<unsigned int> origins;
+  FlexGrid<unsigned int> order;
+
+  SearchMode search;
+  unsigned int levels;
+  bool pyramid;
+  std::unique_ptr<CarvingEngine> coarse;
+  std::vector<unsigned int> coarseSeam;
+  unsigned int coarseWidth;
+  unsigned int pending;
+  std::vector<unsigned int> bandLo;
+  FlexGrid<C> bandCost;
+
+  std::vector<unsigned int> guide;
+  std::vector<C> guideCosts;
+  unsigned int guideWindow;
+  bool guideArmed;
+  bool guided;
+  unsigned int guideNext;
+  unsigned int guidedSeams;
+
+  bool recording;
+  std::vector<unsigned int> recorded;
+  std::vector<C> recordedCosts;
+
+  bool masked;
+  FlexGrid<MaskCell> mask;
+  std::vector<unsigned int> maskRows;
+  std::size_t removeLeft;
+  C protectBias;
+  C removeBias;
+  std::vector<C> biased;
+public:
+  CarvingEngine();
+  explicit CarvingEngine(ThreadPool&);
+  CarvingEngine(const FlexGrid<P>&, const CarvingMode&);
+  CarvingEngine(const FlexGrid<P>&, const CarvingMode&, ThreadPool&);
+
+  void reset(const FlexGrid<P>&, const CarvingMode&);
+  void setMode(const CarvingMode&);
+  void setSearch(const SearchMode&, const unsigned int&);
+  void followSeams(const std::vector<unsigned int>&, const std::vector<C>&, const unsigned int&);
+
+  void removeSeam();
+  void removeSeams(const unsigned int&);
+  void removeSeams(const unsigned int&, const unsigned int&);
+  unsigned int removeSeamBatch(const unsigned int&);
+  void removeCrossSeam(const std::vector<unsigned int>&);
+
+  void trackRemovals();
+  FlexGrid<unsigned int> getRemovalOrder() const;
+
+  void recordSeams();
+  const std::vector<unsigned int>& getRecordedSeams() const;
+  const std::vector<C>& getRecordedCosts() const;
+  unsigned int getGuidedSeams() const;
+
+  void setMask(const FlexGrid<MaskCell>&);
+  FlexGrid<MaskCell> getMask() const;
+  std::size_t getRemovalsLeft() const;
+  unsigned int removeMarked(const unsigned int&, const unsigned int&);
+
+  FlexGrid<P> getGrid() const;
+  const std::vector<unsigned int>& getSeam() const;
+  C getCheapestCost() const;
+  double getRemovedEnergy() const;
+private:
+  void findSeam();
+  void findSeamPyramid();
+  void findSeamGuided();
+  void findSeamBanded(int);
+  bool searchesBands() const;
+  void buildCoarse();
+
+  unsigned int findSeamBatch(const unsigned int&);
+  bool traceSeamAvoiding(unsigned int, unsigned int*) const;
+  template <typename K>
+    static void collapseRow(K*, unsigned int, const std::vector<unsigned int>&);
+  void recalculate();
+  void restart();
+
+  void prepareMask();
+  void calcCostMasked();
+  void compactMask();
+  C maskBias(const MaskCell&) const;
+
+  void updateEnergy();
+  void updateCost();
+  bool useFullCost() const;
+
+  void energyBand(unsigned int, int&, int&) const;
+  void structureBand(unsigned int, int&, int&) const;
+};
+
+#include "CarvingEngine.ipp"
+#endif
@@ -0,0 +1,1495 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "CarvingEngine.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+
+#include "Kernels.hpp"
+#include "Util/Profiler.hpp"
+
+/** Construct a new CarvingEngine object.
+
+    Constructs a new CarvingEngine object, holding an
+    empty pixel grid, for usage with reset.
+ */
+template <typename P, typename E, typename C>
+  CarvingEngine<P, E, C>::CarvingEngine() :
+    mode(CarvingMode::VERTICAL),
+    pool(nullptr),
+    grid(0, 0),
+    spare(0, 0),
+    energy(0, 0),
+    cost(0, 0),
+    coneCells(0),
+    sinceMeasured(0),
+    removedEnergy(0),
+    carvedSeams(0),
+    tracking(false),
+    removedSeams(0),
+    origins(0, 0),
+    order(0, 0),
+    search(SearchMode::FULL),
+    levels(0),
+    pyramid(false),
+    coarseWidth(0),
+    pending(0),
+    bandCost(0, 0),
+    guideWindow(0),
+    guideArmed(false),
+    guided(false),
+    guideNext(0),
+    guidedSeams(0),
+    recording(false),
+    masked(false),
+    mask(0, 0),
+    removeLeft(0),
+    protectBias(0),
+    removeBias(0) { }
+
+/** Construct a new CarvingEngine object.
+
+    Constructs a new CarvingEngine object, holding an
+    empty pixel grid, for usage with reset, which splits
+    its energy and cost grid calculations across the
+    provided thread pool.
+
+    @param pool
+    The thread pool to split calculations across, which
+    must outlive the engine.
+ */
+template <typename P, typename E, typename C>
+  CarvingEngine<P, E, C>::CarvingEngine(ThreadPool& pool) : CarvingEngine() {
+    this->pool = &pool;
+  }
+
+/** Construct a new CarvingEngine object.
+
+    Constructs a new CarvingEngine object, holding a
+    copy of the provided pixel grid, along with its
+    fully calculated energy and cost grids.
+
+    Horizontal carving is performed on a transposed
+    copy of the grid, so that every seam is removed
+    along contiguous rows.
+
+    @param grid
+    The pixel grid to copy and remove seams from.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+ */
+template <typename P, typename E, typename C>
+  CarvingEngine<P, E, C>::CarvingEngine(const FlexGrid<P>& grid, const CarvingMode& mode) : CarvingEngine() {
+    reset(grid, mode);
+  }
+
+/** Construct a new CarvingEngine object.
+
+    Constructs a new CarvingEngine object, which splits
+    its energy and cost grid calculations across the
+    provided thread pool.
+
+    @param grid
+    The pixel grid to copy and remove seams from.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+
+    @param pool
+    The thread pool to split calculations across, which
+    must outlive the engine.
+ */
+template <typename P, typename E, typename C>
+  CarvingEngine<P, E, C>::CarvingEngine(const FlexGrid<P>& grid, const CarvingMode& mode, ThreadPool& pool) :
+    CarvingEngine(pool) {
+    reset(grid, mode);
+  }
+
+/** Starts carving a new pixel grid.
+
+    Replaces the held pixel grid with a copy of the provided
+    grid, and recalculates its energy and cost grids. The
+    memory of every grid is reused whenever it is large
+    enough, so that an engine may carve many images without
+    reallocating. Any mask is dropped along with the old grid.
+
+    @param grid
+    The pixel grid to copy and remove seams from.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::reset(const FlexGrid<P>& grid, const CarvingMode& mode) {
+    this->mode = mode;
+    masked = false;
+    if (mode == CarvingMode::HORIZONTAL) {
+      transposeInto(grid, this->grid);
+    } else {
+      this->grid.assign(grid);
+    }
+    restart();
+  }
+
+/** Switches the carving mode, keeping the carved pixel grid.
+
+    Allows vertical and horizontal seams to be removed from
+    the same grid, without copying it out of the engine.
+    The mask, if any, is carried over to the new mode.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::setMode(const CarvingMode& mode) {
+    if (mode == this->mode) {
+      return;
+    }
+    this->mode = mode;
+
+    transposeInto(grid, spare);
+    std::swap(grid, spare);
+    if (masked) {
+      mask = transpose(mask);
+    }
+    restart();
+  }
+
+/** Selects how seams are searched for.
+
+    A pyramid search finds each seam on a grid downsampled by
+    half in both deminsions, itself carved by an engine searching
+    with one level fewer, then refines the seam within a narrow
+    band around its upscaled path. Each coarse seam guides the
+    removal of two seams, so the full resolution cost grid is never
+    calculated. Grids too small to downsample are searched in full.
+
+    The search takes effect from the next call to reset or setMode.
+
+    @param search
+    How seams are searched for.
+
+    @param levels
+    The number of coarser levels of a pyramid search,
+    0 searches in full.
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::setSearch(const SearchMode& search, const unsigned int& levels) {
+    this->search = search;
+    this->levels = levels;
+  }
+
+/** Guides the next seams by the seams of a similar grid.
+
+    Intended for consecutive frames of a video, where the k-th
+    seam removed from one frame is usually a small shift of
+    the k-th seam removed from the frame before it. The k-th
+    seam is searched for only within the provided number of
+    pixels either side of the k-th guide seam, so the cost grid
+    is never calculated. Should a guided seam cost noticeably
+    more than its guide, the content has changed too much to
+    follow, and the remaining seams are searched in full.
+
+    The guide takes effect from the next call to reset or
+    setMode, and only if the guide seams span as many rows
+    as the grid. It is ignored by pyramid searches.
+
+    @param seams
+    The guide seams, one after the other, each holding one
+    column per row as recorded by recordSeams.
+
+    @param costs
+    The total energy of each guide seam.
+
+    @param window
+    The number of pixels either side of a guide seam to
+    search within.
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::followSeams(const std::vector<unsigned int>& seams, const std::vector<C>& costs,
+                                           const unsigned int& window) {
+    guide.assign(seams.begin(), seams.end());
+    guideCosts.assign(costs.begin(), costs.end());
+    guideWindow = std::max(window, 1u);
+    guideArmed = true;
+  }
+
+/** Removes the seam of least significance.
+
+    Discovers the seam of least significance, removes it
+    from the pixel, energy, and cost grids, then refreshes
+    only the energy and cost values the removal affected.
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::removeSeam() {
+    if (grid.getWidth() < 1 || grid.getHeight() < 1) {
+      throw std::runtime_error("No seams left to remove!");
+    }
+    ProfileScope seamScope(Phase::SEAM, 0, carvedSeams);
+
+    {
+      ProfileScope scope(Phase::TRACEBACK, (grid.getWidth() + 3 * grid.getHeight()) * sizeof(C));
+      if (pyramid) {
+        findSeamPyramid();
+      } else if (guided) {
+        findSeamGuided();
+      } else {
+        findSeam();
+      }
+    }
+    C total = 0;
+    for (unsigned int h = 0; h < grid.getHeight(); ++h) {
+      total += energy(seam[h], h);
+    }
+    removedEnergy += total;
+
+    if (recording) {
+      recorded.insert(recorded.end(), seam.begin(), seam.end());
+      recordedCosts.push_back(total);
+    }
+
+    {
+      // Every grid moves the cells right of the seam, only counted when profiling
+      ProfileScope scope(Phase::REMOVAL, 0);
+      if (Profiler::isEnabled()) {
+        std::size_t moved = 0;
+        for (unsigned int h = 0; h < grid.getHeight(); ++h) {
+          moved += grid.getWidth() - seam[h] - 1;
+        }
+        scope.addBytes(moved * (sizeof(P) + sizeof(E) + (searchesBands() ? 0 : sizeof(C))));
+      }
+
+      if (tracking) {
+        for (unsigned int h = 0; h < grid.getHeight(); ++h) {
+          order(origins(seam[h], h), h) = removedSeams;
+        }
+        compactSeam(origins, seam, CarvingMode::VERTICAL);
+        ++removedSeams;
+      }
+
+      if (masked) {
+        compactMask();
+      }
+      compactSeamV(grid, seam);
+      compactSeamV(energy, seam);
+      // Banded searches never consult the cost grid
+      if (!searchesBands()) {
+        compactSeamV(cost, seam);
+      }
+    }
+    ++carvedSeams;
+    updateEnergy();
+    if (searchesBands()) {
+      return;
+    }
+
+    // Either refresh the affected cone of the cost grid on this
+    // thread, or recalculate the whole grid across the pool
+    if (useFullCost()) {
+      ProfileScope scope(Phase::COST, static_cast<std::size_t>(cost.getWidth()) * cost.getHeight() *
+                                      (sizeof(E) + sizeof(C)));
+      calcCostInto(energy, cost, CarvingMode::VERTICAL, *pool);
+      ++sinceMeasured;
+    } else {
+      updateCost();
+      sinceMeasured = 0;
+    }
+  }
+
+/** Removes multiple seams of least significance.
+
+    @param amt
+    The amt of seams to remove.
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::removeSeams(const unsigned int& amt) {
+    for (unsigned int i = 0; i < amt; ++i) {
+      removeSeam();
+    }
+  }
+
+/** Removes multiple seams, several seams per cost grid calculation.
+
+    Rather than recalculating the cost grid after every seam,
+    up to batch non-crossing seams are discovered using the
+    same cost grid, then removed together. Larger batches
+    trade the quality of later seams, which only account for
+    the earlier seams of their batch by avoiding them, for
+    throughput. A batch size of 1 is equivalent to removeSeams
+    without a batch size. Banded searches, and recorded
+    removals, take one seam at a time regardless of the
+    batch size.
+
+    @param amt
+    The amt of seams to remove.
+
+    @param batch
+    The maximum number of seams to remove per cost
+    grid calculation.
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::removeSeams(const unsigned int& amt, const unsigned int& batch) {
+    unsigned int removed = 0;
+    while (removed < amt) {
+      const unsigned int want = std::min(batch, amt - removed);
+      if (want < 2 || searchesBands() || recording) {
+        removeSeam();
+        ++removed;
+        continue;
+      }
+      removed += removeSeamBatch(want);
+    }
+  }
+
+/** Removes a batch of non-crossing seams using the current cost grid.
+
+    Discovers up to amt seams, each avoiding the pixels of
+    the seams discovered before it, then removes all of them
+    in a single pass over every row, before recalculating
+    the energy and cost grids.
+
+    @param amt
+    The maximum amt of seams to remove.
+
+    @returns the number of seams removed, which is at least 1,
+    but may be less than amt if the seams left no room for more.
+ */
+template <typename P, typename E, typename C>
+  unsigned int CarvingEngine<P, E, C>::removeSeamBatch(const unsigned int& amt) {
+    if (grid.getWidth() < 1 || grid.getHeight() < 1) {
+      throw std::runtime_error("No seams left to remove!");
+    }
+
+    // Batches found too small record no seams, leaving them
+    // to the scope of the seam removed instead
+    ProfileScope seamScope(Phase::SEAM, 0, carvedSeams);
+    unsigned int found;
+    {
+      ProfileScope scope(Phase::TRACEBACK, static_cast<std::size_t>(grid.getWidth()) * grid.getHeight() *
+                                           (sizeof(C) + 1));
+      found = findSeamBatch(std::min(amt, grid.getWidth()));
+    }
+    if (found < 2) {
+      // A batch of one seam is better served by the incremental path
+      seamScope.setSeams(0);
+      removeSeam();
+      return 1;
+    }
+
+    const unsigned int width = grid.getWidth();
+    {
+      ProfileScope scope(Phase::REMOVAL, static_cast<std::size_t>(width) * grid.getHeight() * sizeof(P));
+      std::vector<unsigned int> cols(found);
+      for (unsigned int h = 0; h < grid.getHeight(); ++h) {
+        for (unsigned int i = 0; i < found; ++i) {
+          cols[i] = batchSeams[i * grid.getHeight() + h];
+          removedEnergy += energy(cols[i], h);
+          if (tracking) {
+            // Seams of a batch are ordered by discovery
+            order(origins(cols[i], h), h) = removedSeams + i;
+          }
+        }
+        std::sort(cols.begin(), cols.end());
+
+        // Collapse the row, shifting each run of pixels between
+        // removed pixels left by the number of removed pixels
+        // before it
+        collapseRow(grid.row(h), width, cols);
+        if (tracking) {
+          collapseRow(origins.row(h), width, cols);
+        }
+        if (masked) {
+          MaskCell* cells = mask.row(h);
+          for (unsigned int i = 0; i < found; ++i) {
+            if (cells[cols[i]] != MaskCell::NONE) {
+              --maskRows[h];
+            }
+            if (cells[cols[i]] == MaskCell::REMOVE) {
+              --removeLeft;
+            }
+          }
+          collapseRow(cells, width, cols);
+        }
+      }
+      grid.setWidth(width - found);
+      if (masked) {
+        mask.setWidth(width - found);
+      }
+      if (tracking) {
+        origins.setWidth(width - found);
+        removedSeams += found;
+      }
+    }
+    carvedSeams += found;
+    seamScope.setSeams(found);
+
+    recalculate();
+    return found;
+  }
+
+/** Removes a seam running across the carving mode.
+
+    Allows another engine, carving the same pixel grid in the
+    other mode, to keep this engine in step. Only the energy
+    values next to the seam are recalculated, along with the
+    cost values from the seam's highest point downwards.
+    Removals across the carving mode are neither tracked,
+    nor counted towards the removed energy.
+
+    @param path
+    The seam most recently removed by the other engine, holding
+    the row of the seam in every column of this engine's grid.
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::removeCrossSeam(const std::vector<unsigned int>& path) {
+    if (tracking) {
+      throw std::runtime_error("Removals across the carving mode cannot be tracked!");
+    }
+    if (masked) {
+      throw std::runtime_error("Removals across the carving mode cannot be masked!");
+    }
+    if (grid.getHeight() < 1 || path.size() != grid.getWidth()) {
+      throw std::runtime_error("Seam does not cross the grid!");
+    }
+
+    compactSeam(grid, path, CarvingMode::HORIZONTAL);
+    compactSeam(energy, path, CarvingMode::HORIZONTAL);
+    seam.resize(grid.getHeight());
+
+    // Pixels within a row of the seam gained new neighbors,
+    // every other pixel kept its neighbors, and its energy
+    const unsigned int top = *std::min_element(path.begin(), path.end());
+    const unsigned int bottom = *std::max_element(path.begin(), path.end());
+    const unsigned int first = top > 0 ? top - 1 : 0;
+    calcEnergyRows(grid, energy, std::min(first, grid.getHeight()), std::min(bottom + 1, grid.getHeight()));
+
+    if (pyramid) {
+      pending = 0;
+      buildCoarse();
+      return;
+    }
+    if (guided) {
+      return;
+    }
+
+    // Every cost row below the first changed energy row may change
+    compactSeam(cost, path, CarvingMode::HORIZONTAL);
+    for (unsigned int h = first; h < cost.getHeight(); ++h) {
+      if (h == 0) {
+        std::copy(energy.row(0), energy.row(0) + cost.getWidth(), cost.row(0));
+      } else {
+        costRow(energy.row(h), cost.row(h - 1), cost.row(h), cost.getWidth(), true, true);
+      }
+    }
+  }
+
+/** Starts recording the order in which pixels are removed.
+
+    Every pixel of the current grid is labelled with the
+    number of seams removed before the seam which removed it,
+    as counted from this call. Recording stops when the engine
+    is reset, or its carving mode changes.
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::trackRemovals() {
+    tracking = true;
+    removedSeams = 0;
+
+    origins.reshape(grid.getWidth(), grid.getHeight());
+    order.reshape(grid.getWidth(), grid.getHeight());
+    for (unsigned int h = 0; h < grid.getHeight(); ++h) {
+      unsigned int* originRow = origins.row(h);
+      unsigned int* orderRow = order.row(h);
+      for (unsigned int w = 0; w < grid.getWidth(); ++w) {
+        originRow[w] = w;
+        orderRow[w] = std::numeric_limits<unsigned int>::max();
+      }
+    }
+  }
+
+/** Retrieves the order in which pixels were removed.
+
+    Removing the first k seams recorded is equivalent to
+    keeping only the pixels whose order is at least k, for any
+    k up to the number of seams removed.
+
+    @returns a grid the size of the grid when recording began,
+    in its original orientation, holding the number of seams
+    removed before each pixel's removal. Pixels which were
+    never removed hold the total number of seams removed.
+ */
+template <typename P, typename E, typename C>
+  FlexGrid<unsigned int> CarvingEngine<P, E, C>::getRemovalOrder() const {
+    if (!tracking) {
+      throw std::runtime_error("Removals are not being tracked!");
+    }
+
+    FlexGrid<unsigned int> result = mode == CarvingMode::HORIZONTAL ? transpose(order) : order;
+    for (unsigned int h = 0; h < result.getHeight(); ++h) {
+      unsigned int* row = result.row(h);
+      for (unsigned int w = 0; w < result.getWidth(); ++w) {
+        row[w] = std::min(row[w], removedSeams);
+      }
+    }
+    return result;
+  }
+
+/** Starts recording the path and cost of every removed seam.
+
+    Recording stops when the engine is reset, or its carving
+    mode changes. The recorded seams may guide the seams of
+    the next frame through followSeams.
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::recordSeams() {
+    recording = true;
+    recorded.clear();
+    recordedCosts.clear();
+  }
+
+/** Retrieves the path of every recorded seam.
+
+    @returns the recorded seams, one after the other, each
+    holding the column of the seam in every row at the time
+    of its removal.
+ */
+template <typename P, typename E, typename C>
+  const std::vector<unsigned int>& CarvingEngine<P, E, C>::getRecordedSeams() const {
+    return recorded;
+  }
+
+/** Retrieves the cost of every recorded seam.
+
+    @returns the total energy of each recorded seam.
+ */
+template <typename P, typename E, typename C>
+  const std::vector<C>& CarvingEngine<P, E, C>::getRecordedCosts() const {
+    return recordedCosts;
+  }
+
+/** Gets the number of seams found by following a guide.
+
+    @returns the number of seams found within the window of
+    their guide seam since the last reset or mode change.
+ */
+template <typename P, typename E, typename C>
+  unsigned int CarvingEngine<P, E, C>::getGuidedSeams() const {
+    return guidedSeams;
+  }
+
+/** Protects some pixels of the grid, and marks others for removal.
+
+    Biases the energy of every masked pixel while calculating
+    costs, so that any seam avoiding the protected pixels is
+    cheaper than every seam crossing them, and any seam crossing
+    more pixels marked for removal is cheaper than every seam
+    crossing fewer. Among seams crossing as many masked pixels,
+    the seam of least energy wins. The mask is carved along with
+    the grid, keeping every mask cell on its pixel.
+
+    Requires a signed cost type, wide enough to hold the biased
+    seams, and a full search. The mask lasts until the next reset.
+
+    @param mask
+    The mask, holding one cell per pixel of the grid, in the
+    orientation the grid was provided in.
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::setMask(const FlexGrid<MaskCell>& mask) {
+    if (!std::numeric_limits<C>::is_signed) {
+      throw std::runtime_error("Masks require a signed cost type!");
+    }
+    if (mode == CarvingMode::HORIZONTAL) {
+      transposeInto(mask, this->mask);
+    } else {
+      this->mask.assign(mask);
+    }
+    if (this->mask.getWidth() != grid.getWidth() || this->mask.getHeight() != grid.getHeight()) {
+      throw std::runtime_error("Mask deminsions do not match the image!");
+    }
+
+    prepareMask();
+    masked = true;
+    calcCostMasked();
+  }
+
+/** Retrieves the carved mask.
+
+    @returns a copy of the mask, with every removed pixel's
+    cell removed, in the orientation the grid was provided in.
+ */
+template <typename P, typename E, typename C>
+  FlexGrid<MaskCell> CarvingEngine<P, E, C>::getMask() const {
+    if (mode == CarvingMode::HORIZONTAL) {
+      return transpose(mask);
+    }
+    return mask;
+  }
+
+/** Gets the number of pixels still marked for removal.
+
+    @returns the number of mask cells marked for removal,
+    0 without a mask.
+ */
+template <typename P, typename E, typename C>
+  std::size_t CarvingEngine<P, E, C>::getRemovalsLeft() const {
+    return masked ? removeLeft : 0;
+  }
+
+/** Removes seams until no pixel is marked for removal.
+
+    As seams crossing marked pixels are always preferred, every
+    seam removes at least one marked pixel while any are left,
+    so far fewer seams than the limit are often enough.
+
+    @param limit
+    The maximum number of seams to remove.
+
+    @param batch
+    The maximum number of seams to remove per cost
+    grid calculation, as for removeSeams.
+
+    @returns the number of seams removed.
+ */
+template <typename P, typename E, typename C>
+  unsigned int CarvingEngine<P, E, C>::removeMarked(const unsigned int& limit, const unsigned int& batch) {
+    unsigned int removed = 0;
+    while (removed < limit && getRemovalsLeft() > 0) {
+      // A seam removes at most one marked pixel per row, so the
+      // row holding the most marked pixels bounds the batch,
+      // keeping it from running past the last marked pixel
+      unsigned int most = 0;
+      for (unsigned int h = 0; h < mask.getHeight(); ++h) {
+        if (maskRows[h] > 0) {
+          const MaskCell* cells = mask.row(h);
+          const unsigned int count = std::count(cells, cells + mask.getWidth(), MaskCell::REMOVE);
+          most = std::max(most, count);
+        }
+      }
+
+      const unsigned int want = std::min(std::min(batch, limit - removed), most);
+      if (want < 2 || recording) {
+        removeSeam();
+        ++removed;
+        continue;
+      }
+      removed += removeSeamBatch(want);
+    }
+    return removed;
+  }
+
+/** Retrieves the carved pixel grid.
+
+    @returns the pixel grid, with all removed seams
+    removed, in its original orientation.
+ */
+template <typename P, typename E, typename C>
+  FlexGrid<P> CarvingEngine<P, E, C>::getGrid() const {
+    return mode == CarvingMode::HORIZONTAL ? transpose(grid) : grid;
+  }
+
+/** Retrieves the most recently removed seam.
+
+    @returns the column of the seam in every row for
+    vertical seams, or the row of the seam in every
+    column for horizontal seams.
+ */
+template <typename P, typename E, typename C>
+  const std::vector<unsigned int>& CarvingEngine<P, E, C>::getSeam() const {
+    return seam;
+  }
+
+/** Gets the cost of the next seam a full search would remove.
+
+    @returns the total energy of the cheapest seam.
+ */
+template <typename P, typename E, typename C>
+  C CarvingEngine<P, E, C>::getCheapestCost() const {
+    if (searchesBands()) {
+      throw std::runtime_error("Banded searches do not calculate seam costs!");
+    }
+    if (cost.getWidth() < 1 || cost.getHeight() < 1) {
+      throw std::runtime_error("No seams left to remove!");
+    }
+    const C* last = cost.row(cost.getHeight() - 1);
+    return *std::min_element(last, last + cost.getWidth());
+  }
+
+/** Gets the total energy of every removed pixel.
+
+    Sums the energy each pixel had at the time of its removal,
+    lower totals indicate less noticeable seams, making this a
+    measure of carving quality.
+
+    @returns the total removed energy.
+ */
+template <typename P, typename E, typename C>
+  double CarvingEngine<P, E, C>::getRemovedEnergy() const {
+    return removedEnergy;
+  }
+
+/** Discovers the seam of least significance.
+
+    Traces the path of least cost back up through the
+    cost grid, recording the column of the seam in
+    every row.
+
+    Ties are resolved in the same manner as traceBackRemV
+    and traceBackRemH, for their respective carving modes.
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::findSeam() {
+    const unsigned int width = cost.getWidth();
+    const unsigned int height = cost.getHeight();
+
+    // Finding starting point by locating the smallest
+    // cost value in the last row
+    const C* last = cost.row(height - 1);
+    unsigned int next = 0;
+    if (mode == CarvingMode::VERTICAL) {
+      for (unsigned int w = width - 1; w + 1 > 0; --w) {
+        if (last[w] < last[next]) {
+          next = w;
+        }
+      }
+    } else {
+      for (unsigned int w = 0; w < width; ++w) {
+        if (last[w] < last[next]) {
+          next = w;
+        }
+      }
+    }
+    seam[height - 1] = next;
+
+    // Follow the path created during the cost grid's
+    // calculation, row by row
+    for (unsigned int h = height - 1; h > 0; --h) {
+      const C* prev = cost.row(h - 1);
+
+      const bool hasLeft = next > 0;
+      const bool hasRight = next < width - 1;
+
+      C minVal = prev[next];
+      if (hasLeft) {
+        minVal = std::min(minVal, prev[next - 1]);
+      }
+      if (hasRight) {
+        minVal = std::min(minVal, prev[next + 1]);
+      }
+
+      if (hasLeft && prev[next - 1] == minVal) {
+        --next;
+      } else if (mode == CarvingMode::VERTICAL) {
+        next = prev[next] == minVal ? next : next + 1;
+      } else if (hasRight && prev[next + 1] == minVal) {
+        ++next;
+      }
+      seam[h - 1] = next;
+    }
+  }
+
+/** Discovers the seam of least significance, coarse to fine.
+
+    Every second seam removes a seam from the coarse engine,
+    both seams are then refined around the coarse seam's path.
+    Once the coarse grid runs out of seams, the full grid is
+    searched instead.
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::findSeamPyramid() {
+    if (pending == 0) {
+      if (coarse->grid.getWidth() < 1) {
+        pyramid = false;
+        recalculate();
+        findSeam();
+        return;
+      }
+      coarseWidth = coarse->grid.getWidth();
+      coarse->removeSeam();
+      coarseSeam.assign(coarse->seam.begin(), coarse->seam.end());
+      pending = 2;
+    }
+    --pending;
+
+    const int BAND = 4;
+    const int width = grid.getWidth();
+    const unsigned int height = grid.getHeight();
+    const int count = std::min(2 * BAND + 1, width);
+
+    // Center each row's band on the coarse seam, as the coarse
+    // grid is narrowed at half the rate of this grid the coarse
+    // seam is scaled by the ratio of their current widths
+    bandLo.resize(height);
+    for (unsigned int h = 0; h < height; ++h) {
+      const std::uint64_t c = coarseSeam[std::min<std::size_t>(h / 2, coarseSeam.size() - 1)];
+      const int center = static_cast<int>((2 * c + 1) * width / (2 * coarseWidth));
+      bandLo[h] = std::max(std::min(center - BAND, width - count), 0);
+    }
+    findSeamBanded(count);
+  }
+
+/** Discovers the seam of least significance around the next guide seam.
+
+    Once the guide runs out of seams, or the guided seam costs
+    too much more than its guide, the cost grid is calculated
+    and every remaining seam is searched in full.
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::findSeamGuided() {
+    // How much more a guided seam may cost than its guide,
+    // on top of one unit of energy per row
+    const double DRIFT = 1.5;
+
+    const int width = grid.getWidth();
+    const unsigned int height = grid.getHeight();
+    if (guideNext < guideCosts.size()) {
+      const int count = std::min(2 * static_cast<int>(guideWindow) + 1, width);
+      const unsigned int* path = &guide[static_cast<std::size_t>(guideNext) * height];
+
+      bandLo.resize(height);
+      for (unsigned int h = 0; h < height; ++h) {
+        const int center = path[h];
+        bandLo[h] = std::max(std::min(center - static_cast<int>(guideWindow), width - count), 0);
+      }
+      findSeamBanded(count);
+
+      double total = 0;
+      for (unsigned int h = 0; h < height; ++h) {
+        total += energy(seam[h], h);
+      }
+      if (total <= DRIFT * guideCosts[guideNext] + height) {
+        ++guideNext;
+        ++guidedSeams;
+        return;
+      }
+    }
+
+    guided = false;
+    recalculate();
+    findSeam();
+  }
+
+/** Discovers the seam of least significance within the bands of bandLo.
+
+    Each row's band starts at its entry of bandLo, and the cost
+    of the cells within it is calculated as usual, with cells
+    outside of the band treated as missing. Consecutive bands
+    must overlap. Ties are resolved in the same manner as findSeam.
+
+    @param count
+    The number of cells in every band.
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::findSeamBanded(int count) {
+    const C UNREACHABLE = std::numeric_limits<C>::max();
+    const unsigned int height = grid.getHeight();
+
+    bandCost.reshape(count, height);
+    const E* eRow = energy.row(0);
+    C* out = bandCost.row(0);
+    for (int i = 0; i < count; ++i) {
+      out[i] = eRow[bandLo[0] + i];
+    }
+    for (unsigned int h = 1; h < height; ++h) {
+      const int lo = bandLo[h];
+      const int shift = lo - static_cast<int>(bandLo[h - 1]);
+      const C* prev = bandCost.row(h - 1);
+      eRow = energy.row(h);
+      out = bandCost.row(h);
+      for (int i = 0; i < count; ++i) {
+        // The predecessors' positions within the previous band
+        const int p = i + shift;
+        C minVal = UNREACHABLE;
+        for (int j = std::max(p - 1, 0); j <= std::min(p + 1, count - 1); ++j) {
+          minVal = std::min(minVal, prev[j]);
+        }
+        out[i] = minVal == UNREACHABLE ? UNREACHABLE : static_cast<C>(eRow[lo + i] + minVal);
+      }
+    }
+
+    // Finding starting point by locating the smallest
+    // cost value in the last band
+    const C* last = bandCost.row(height - 1);
+    int next = 0;
+    if (mode == CarvingMode::VERTICAL) {
+      for (int i = count - 1; i >= 0; --i) {
+        if (last[i] < last[next]) {
+          next = i;
+        }
+      }
+    } else {
+      for (int i = 0; i < count; ++i) {
+        if (last[i] < last[next]) {
+          next = i;
+        }
+      }
+    }
+    int col = bandLo[height - 1] + next;
+    seam[height - 1] = col;
+
+    // Follow the path, treating cells outside of
+    // the previous band as missing
+    for (unsigned int h = height - 1; h > 0; --h) {
+      const int lo = bandLo[h - 1];
+      const C* prev = bandCost.row(h - 1);
+      const bool hasLeft = col - 1 >= lo && col - 1 < lo + count;
+      const bool hasCenter = col >= lo && col < lo + count;
+      const bool hasRight = col + 1 >= lo && col + 1 < lo + count;
+
+      C minVal = UNREACHABLE;
+      if (hasLeft) {
+        minVal = std::min(minVal, prev[col - 1 - lo]);
+      }
+      if (hasCenter) {
+        minVal = std::min(minVal, prev[col - lo]);
+      }
+      if (hasRight) {
+        minVal = std::min(minVal, prev[col + 1 - lo]);
+      }
+
+      if (hasLeft && prev[col - 1 - lo] == minVal) {
+        --col;
+      } else if (mode == CarvingMode::VERTICAL) {
+        col = hasCenter && prev[col - lo] == minVal ? col : col + 1;
+      } else if (hasRight && prev[col + 1 - lo] == minVal) {
+        ++col;
+      }
+      seam[h - 1] = col;
+    }
+  }
+
+/** Discovers a batch of non-crossing seams using the current cost grid.
+
+    Seams are traced back from the cheapest cells of the last
+    row first. Each seam follows the cheapest predecessor which
+    no earlier seam has claimed, and which would not cross an
+    earlier seam. Seams which become boxed in are abandoned,
+    and tracing moves on to the next cheapest starting cell.
+
+    @param amt
+    The maximum amt of seams to discover.
+
+    @returns the number of seams discovered, each stored
+    in batchSeams.
+ */
+template <typename P, typename E, typename C>
+  unsigned int CarvingEngine<P, E, C>::findSeamBatch(const unsigned int& amt) {
+    const unsigned int width = cost.getWidth();
+    const unsigned int height = cost.getHeight();
+
+    batchSeams.resize(static_cast<std::size_t>(amt) * height);
+    used.assign(static_cast<std::size_t>(width) * height, 0);
+
+    // Order the starting cells by cost, cheapest first
+    const C* last = cost.row(height - 1);
+    std::vector<unsigned int> starts(width);
+    for (unsigned int w = 0; w < width; ++w) {
+      starts[w] = w;
+    }
+    std::stable_sort(starts.begin(), starts.end(), [last](unsigned int a, unsigned int b) {
+      return last[a] < last[b];
+    });
+
+    unsigned int found = 0;
+    for (unsigned int i = 0; i < width && found < amt; ++i) {
+      unsigned int* path = &batchSeams[static_cast<std::size_t>(found) * height];
+      if (!traceSeamAvoiding(starts[i], path)) {
+        continue;
+      }
+      for (unsigned int h = 0; h < height; ++h) {
+        used[static_cast<std::size_t>(h) * width + path[h]] = 1;
+      }
+      ++found;
+    }
+    return found;
+  }
+
+/** Traces a seam back from a starting cell, avoiding claimed pixels.
+
+    @param start
+    The column of the last row to start from.
+
+    @param path
+    Set to the column of the seam in every row.
+
+    @returns true if the seam reached the first row,
+    false if it was boxed in by earlier seams.
+ */
+template <typename P, typename E, typename C>
+  bool CarvingEngine<P, E, C>::traceSeamAvoiding(unsigned int start, unsigned int* path) const {
+    const unsigned int width = cost.getWidth();
+    const unsigned int height = cost.getHeight();
+    auto isUsed = [&](unsigned int w, unsigned int h) {
+      return used[static_cast<std::size_t>(h) * width + w] != 0;
+    };
+
+    if (isUsed(start, height - 1)) {
+      return false;
+    }
+
+    unsigned int next = start;
+    path[height - 1] = next;
+    for (unsigned int h = height - 1; h > 0; --h) {
+      const C* prev = cost.row(h - 1);
+
+      // Consider the center first, so that it wins ties
+      bool found = false;
+      unsigned int best = next;
+      if (!isUsed(next, h - 1)) {
+        found = true;
+      }
+      // Diagonal moves must not cross an earlier seam, which
+      // would pass through both cells of the other diagonal
+      if (next > 0 && !isUsed(next - 1, h - 1) && !(isUsed(next - 1, h) && isUsed(next, h - 1))) {
+        if (!found || prev[next - 1] < prev[best]) {
+          best = next - 1;
+          found = true;
+        }
+      }
+      if (next < width - 1 && !isUsed(next + 1, h - 1) && !(isUsed(next + 1, h) && isUsed(next, h - 1))) {
+        if (!found || prev[next + 1] < prev[best]) {
+          best = next + 1;
+          found = true;
+        }
+      }
+
+      if (!found) {
+        return false;
+      }
+      next = best;
+      path[h - 1] = next;
+    }
+    return true;
+  }
+
+/** Removes several pixels from a row, in a single pass.
+
+    @param row
+    The row to remove from.
+
+    @param width
+    The width of the row, before removal.
+
+    @param cols
+    The columns to remove, in ascending order.
+ */
+template <typename P, typename E, typename C>
+template <typename K>
+  void CarvingEngine<P, E, C>::collapseRow(K* row, unsigned int width, const std::vector<unsigned int>& cols) {
+    unsigned int write = cols[0];
+    for (unsigned int i = 0; i < cols.size(); ++i) {
+      const unsigned int next = i + 1 < cols.size() ? cols[i + 1] : width;
+      std::copy(row + cols[i] + 1, row + next, row + write);
+      write += next - cols[i] - 1;
+    }
+  }
+
+/** Recalculates the energy and cost grids from scratch.
+
+    The cost grid is skipped while searching within bands,
+    and is calculated on this thread while masked.
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::recalculate() {
+    const std::size_t cells = static_cast<std::size_t>(grid.getWidth()) * grid.getHeight();
+    {
+      ProfileScope scope(Phase::ENERGY, cells * (sizeof(P) + sizeof(E)));
+      if (pool) {
+        calcEnergyInto(grid, energy, *pool);
+      } else {
+        calcEnergyInto(grid, energy);
+      }
+    }
+    if (searchesBands()) {
+      return;
+    }
+
+    ProfileScope scope(Phase::COST, cells * (sizeof(E) + sizeof(C)));
+    if (masked) {
+      calcCostMasked();
+    } else if (pool) {
+      calcCostInto(energy, cost, CarvingMode::VERTICAL, *pool);
+    } else {
+      calcCostInto(energy, cost, CarvingMode::VERTICAL);
+    }
+  }
+
+/** Recalculates every grid, and clears all carving statistics.
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::restart() {
+    const unsigned int PYRAMID_MIN = 64;
+
+    pyramid = search == SearchMode::PYRAMID && levels > 0 &&
+              grid.getWidth() >= PYRAMID_MIN && grid.getHeight() >= PYRAMID_MIN;
+    guided = guideArmed && !pyramid && !guideCosts.empty() &&
+             guide.size() == guideCosts.size() * grid.getHeight();
+    guideArmed = false;
+    guideNext = 0;
+    guidedSeams = 0;
+    if (masked) {
+      prepareMask();
+    }
+    recalculate();
+    seam.resize(grid.getHeight());
+    coneCells = 0;
+    sinceMeasured = 0;
+    removedEnergy = 0;
+    carvedSeams = 0;
+    tracking = false;
+    recording = false;
+
+    pending = 0;
+    if (pyramid) {
+      buildCoarse();
+    }
+  }
+
+/** Checks whether seams are searched for within bands, without a cost grid.
+
+    @returns true while searching a pyramid, or following a guide.
+ */
+template <typename P, typename E, typename C>
+  bool CarvingEngine<P, E, C>::searchesBands() const {
+    return pyramid || guided;
+  }
+
+/** Downsamples the pixel grid into the next level of the pyramid.
+
+    Every coarse pixel is the rounded average of a 2x2 block
+    of pixels, or of what remains of the block along the
+    grid's edges. The coarse engine is carved in the same
+    orientation, following this engine's tie breaking.
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::buildCoarse() {
+    const unsigned int width = grid.getWidth();
+    const unsigned int height = grid.getHeight();
+
+    if (!coarse) {
+      coarse.reset(new CarvingEngine());
+    }
+    coarse->pool = pool;
+    coarse->mode = mode;
+    coarse->setSearch(search, levels - 1);
+
+    FlexGrid<P>& small = coarse->grid;
+    small.reshape((width + 1) / 2, (height + 1) / 2);
+    for (unsigned int h = 0; h < small.getHeight(); ++h) {
+      const P* top = grid.row(2 * h);
+      const P* bottom = grid.row(std::min(2 * h + 1, height - 1));
+      P* out = small.row(h);
+      for (unsigned int w = 0; w < small.getWidth(); ++w) {
+        const unsigned int right = std::min(2 * w + 1, width - 1);
+        const std::int64_t sum = static_cast<std::int64_t>(top[2 * w]) + top[right] + bottom[2 * w] + bottom[right];
+        out[w] = static_cast<P>((sum + 2) / 4);
+      }
+    }
+    coarse->restart();
+  }
+
+/** Counts the masked cells of every row, and sizes the mask's biases.
+
+    Every pixel's energy is at most four times the largest pixel,
+    so a removal bias exceeding the energy of an entire seam
+    outweighs any difference in energy, and a protection bias
+    exceeding the removal bias and energy of an entire seam
+    outweighs everything else.
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::prepareMask() {
+    if (searchesBands()) {
+      throw std::runtime_error("Masks cannot be combined with banded searches!");
+    }
+
+    const unsigned int width = grid.getWidth();
+    const unsigned int height = grid.getHeight();
+    double maxPixel = 0;
+    maskRows.assign(height, 0);
+    removeLeft = 0;
+    for (unsigned int h = 0; h < height; ++h) {
+      const P* row = grid.row(h);
+      const MaskCell* cells = mask.row(h);
+      for (unsigned int w = 0; w < width; ++w) {
+        maxPixel = std::max<double>(maxPixel, row[w]);
+        if (cells[w] != MaskCell::NONE) {
+          ++maskRows[h];
+        }
+        if (cells[w] == MaskCell::REMOVE) {
+          ++removeLeft;
+        }
+      }
+    }
+
+    const double maxEnergy = 4 * maxPixel + 1;
+    const double remove = height * maxEnergy + 1;
+    const double protect = height * (maxEnergy + remove) + 1;
+    if (height * (maxEnergy + protect) >= static_cast<double>(std::numeric_limits<C>::max())) {
+      throw std::runtime_error("Image is too large to carve with a mask!");
+    }
+    removeBias = static_cast<C>(remove);
+    protectBias = static_cast<C>(protect);
+  }
+
+/** Recalculates the whole cost grid, biased by the mask.
+
+    Rows without any masked cell are calculated straight from
+    their energy, only rows holding masked cells are biased
+    into a scratch row first.
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::calcCostMasked() {
+    const unsigned int width = energy.getWidth();
+    const unsigned int height = energy.getHeight();
+
+    cost.reshape(width, height);
+    biased.resize(width);
+    for (unsigned int h = 0; h < height; ++h) {
+      const E* eRow = energy.row(h);
+      C* out = cost.row(h);
+      if (maskRows[h] > 0) {
+        const MaskCell* cells = mask.row(h);
+        for (unsigned int w = 0; w < width; ++w) {
+          biased[w] = eRow[w] + maskBias(cells[w]);
+        }
+        if (h == 0) {
+          std::copy(biased.begin(), biased.end(), out);
+        } else {
+          costRow(biased.data(), cost.row(h - 1), out, width, true, true);
+        }
+      } else if (h == 0) {
+        std::copy(eRow, eRow + width, out);
+      } else {
+        costRow(eRow, cost.row(h - 1), out, width, true, true);
+      }
+    }
+  }
+
+/** Removes the current seam from the mask.
+
+    Keeps the masked cell counts in step with the mask.
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::compactMask() {
+    for (unsigned int h = 0; h < mask.getHeight(); ++h) {
+      const MaskCell cell = mask(seam[h], h);
+      if (cell != MaskCell::NONE) {
+        --maskRows[h];
+      }
+      if (cell == MaskCell::REMOVE) {
+        --removeLeft;
+      }
+    }
+    compactSeam(mask, seam, CarvingMode::VERTICAL);
+  }
+
+/** Gets the bias a mask cell adds to its pixel's energy.
+
+    @param cell
+    The mask cell.
+
+    @returns the bias, negative for pixels marked for removal.
+ */
+template <typename P, typename E, typename C>
+  C CarvingEngine<P, E, C>::maskBias(const MaskCell& cell) const {
+    switch (cell) {
+      case MaskCell::PROTECT:
+        return protectBias;
+      case MaskCell::REMOVE:
+        return -removeBias;
+      default:
+        return 0;
+    }
+  }
+
+/** Refreshes the energy values next to the removed seam.
+
+    Only pixels which gained a new neighbor from the
+    removal have their energy recalculated.
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::updateEnergy() {
+    ProfileScope scope(Phase::ENERGY, 0);
+    std::size_t cells = 0;
+    for (unsigned int h = 0; h < grid.getHeight(); ++h) {
+      int lo, hi;
+      energyBand(h, lo, hi);
+      for (int w = lo; w <= hi; ++w) {
+        energy(w, h) = calcEnergyAt<P, E>(grid, w, h);
+      }
+      cells += std::max(hi - lo + 1, 0);
+    }
+    scope.addBytes(cells * (sizeof(P) + sizeof(E)));
+  }
+
+/** Refreshes the cost values affected by the removed seam.
+
+    Recalculates a row's costs only where its energy changed,
+    where its relationship with the previous row changed,
+    or where the previous row's costs changed. As the cost
+    of a cell only influences its three successors, the
+    refreshed range widens by at most one cell per row, and
+    narrows again as soon as the recalculated costs match
+    the old ones.
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::updateCost() {
+    const int width = cost.getWidth();
+    ProfileScope scope(Phase::COST, 0);
+
+    // The range of the previous row whose cost changed,
+    // empty when lo > hi
+    int changedLo = 1;
+    int changedHi = 0;
+
+    coneCells = 0;
+
+    for (unsigned int h = 0; h < cost.getHeight(); ++h) {
+      int lo, hi;
+      energyBand(h, lo, hi);
+      if (h > 0) {
+        int sLo, sHi;
+        structureBand(h, sLo, sHi);
+        lo = std::min(lo, sLo);
+        hi = std::max(hi, sHi);
+      }
+      if (changedLo <= changedHi) {
+        lo = std::min(lo, changedLo - 1);
+        hi = std::max(hi, changedHi + 1);
+      }
+      lo = std::max(lo, 0);
+      hi = std::min(hi, width - 1);
+
+      const E* eRow = energy.row(h);
+      const C* prev = h > 0 ? cost.row(h - 1) : nullptr;
+      C* out = cost.row(h);
+      // Only rows holding masked cells need their energy biased
+      const MaskCell* cells = masked && maskRows[h] > 0 ? mask.row(h) : nullptr;
+
+      changedLo = 1;
+      changedHi = 0;
+      coneCells += std::max(hi - lo + 1, 0);
+      for (int w = lo; w <= hi; ++w) {
+        C val = eRow[w];
+        if (cells) {
+          val += maskBias(cells[w]);
+        }
+        if (prev) {
+          C minVal = prev[w];
+          if (w > 0) {
+            minVal = std::min(minVal, prev[w - 1]);
+          }
+          if (w < width - 1) {
+            minVal = std::min(minVal, prev[w + 1]);
+          }
+          val += minVal;
+        }
+
+        if (val != out[w]) {
+          out[w] = val;
+          if (changedLo > changedHi) {
+            changedLo = w;
+          }
+          changedHi = w;
+        }
+      }
+    }
+    scope.addBytes(coneCells * (sizeof(E) + sizeof(C)));
+  }
+
+/** Decides whether to recalculate the whole cost grid.
+
+    Recalculating the whole cost grid across the thread pool
+    is preferable once the cone of affected cells, split over
+    the pool's threads, outweighs it. The cone's size varies
+    slowly from seam to seam, so it is only measured again
+    periodically while whole grid recalculation is in use.
+
+    Masked cost grids are never split across the pool.
+
+    @returns true if the whole cost grid should be
+    recalculated across the thread pool.
+ */
+template <typename P, typename E, typename C>
+  bool CarvingEngine<P, E, C>::useFullCost() const {
+    const unsigned int REMEASURE = 32;
+
+    if (masked || !pool || pool->size() < 2 || sinceMeasured >= REMEASURE) {
+      return false;
+    }
+    const std::size_t cells = static_cast<std::size_t>(cost.getWidth()) * cost.getHeight();
+    return coneCells * pool->size() > 2 * cells;
+  }
+
+/** Finds the cells of a row whose energy the removed seam affected.
+
+    A pixel's energy changes when either its horizontal
+    neighbors changed, which happens directly beside the seam,
+    or its vertical neighbors changed, which happens
+    between the seam's position in adjacent rows.
+
+    @param h
+    The row to examine.
+
+    @param lo
+    Set to the first affected column.
+
+    @param hi
+    Set to the last affected column, lo > hi if
+    no column is affected.
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::energyBand(unsigned int h, int& lo, int& hi) const {
+    int sMin = seam[h];
+    int sMax = seam[h];
+    if (h > 0) {
+      sMin = std::min<int>(sMin, seam[h - 1]);
+      sMax = std::max<int>(sMax, seam[h - 1]);
+    }
+    if (h < grid.getHeight() - 1) {
+      sMin = std::min<int>(sMin, seam[h + 1]);
+      sMax = std::max<int>(sMax, seam[h + 1]);
+    }
+    lo = std::max(sMin - 1, 0);
+    hi = std::min<int>(sMax, grid.getWidth() - 1);
+  }
+
+/** Finds the cells of a row whose predecessors the removed seam changed.
+
+    Cells on the same side of the seam in both a row and its
+    previous row keep the same three predecessors, only cells
+    between the seam's positions in the two rows do not.
+
+    @param h
+    The row to examine, must be greater than 0.
+
+    @param lo
+    Set to the first affected column.
+
+    @param hi
+    Set to the last affected column, lo > hi if
+    no column is affected.
+ */
+template <typename P, typename E, typename C>
+  void CarvingEngine<P, E, C>::structureBand(unsigned int h, int& lo, int& hi) const {
+    const int cur = seam[h];
+    const int prev = seam[h - 1];
+    lo = std::max(std::min(cur, prev - 1), 0);
+    hi = std::min<int>(std::max(cur - 1, prev), grid.getWidth() - 1);
+  }
@@ -0,0 +1,70 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef CARVINGTYPES_HPP
+#define CARVINGTYPES_HPP
+
+#include <cstdint>
+
+/** The type energy values of a pixel type are stored in.
+
+    An energy value is the sum of four absolute differences
+    between pixels, so it requires 2 more bits than a pixel.
+    Other pixel types keep their energy values in their own
+    type.
+ */
+template <typename P>
+struct EnergyOf {
+  typedef P type;
+};
+
+template <>
+struct EnergyOf<std::uint8_t> {
+  typedef std::uint16_t type;
+};
+
+template <>
+struct EnergyOf<std::uint16_t> {
+  typedef std::uint32_t type;
+};
+
+/** The type cost values of an energy type are accumulated in.
+
+    A cost value is the sum of an entire seam's energy values,
+    so narrow energy types are accumulated in a wider type.
+ */
+template <typename E>
+struct CostOf {
+  typedef E type;
+};
+
+template <>
+struct CostOf<std::uint16_t> {
+  typedef std::uint32_t type;
+};
+
+/** The type cost values are accumulated in when seams
+    are long enough to overflow the usual cost type.
+ */
+template <typename C>
+struct WideCostOf {
+  typedef C type;
+};
+
+template <>
+struct WideCostOf<std::uint32_t> {
+  typedef std::uint64_t type;
+};
+#endif
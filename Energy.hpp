@@ -0,0 +1,60 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ENERGY_HPP
+#define ENERGY_HPP
+
+/** The sum of the absolute differences between a pixel and
+    its four adjacent pixels, matching calcEnergy.
+ */
+struct GradientEnergy {
+  template <typename P, typename E>
+    static E energyAt(const P*, const P*, const P*, unsigned int, unsigned int);
+  template <typename P, typename E, typename C>
+    static void costRun(const P*, const P*, const P*, const C*, C*, E*, unsigned int, unsigned int,
+                        unsigned int);
+  template <typename P, typename C>
+    static void moveCosts(const P*, const P*, unsigned int, unsigned int, C*);
+};
+
+/** Half of the sum of the absolute horizontal and vertical
+    Sobel gradients, over the 3x3 block around a pixel.
+ */
+struct SobelEnergy {
+  template <typename P, typename E>
+    static E energyAt(const P*, const P*, const P*, unsigned int, unsigned int);
+  template <typename P, typename E, typename C>
+    static void costRun(const P*, const P*, const P*, const C*, C*, E*, unsigned int, unsigned int,
+                        unsigned int);
+  template <typename P, typename C>
+    static void moveCosts(const P*, const P*, unsigned int, unsigned int, C*);
+};
+
+/** Forward energy, the difference between the pixels which
+    become adjacent once a seam is removed, so that the seam
+    costs what it adds to the image rather than what it takes.
+ */
+struct ForwardEnergy {
+  template <typename P, typename E>
+    static E energyAt(const P*, const P*, const P*, unsigned int, unsigned int);
+  template <typename P, typename E, typename C>
+    static void costRun(const P*, const P*, const P*, const C*, C*, E*, unsigned int, unsigned int,
+                        unsigned int);
+  template <typename P, typename C>
+    static void moveCosts(const P*, const P*, unsigned int, unsigned int, C*);
+};
+
+#include "Energy.ipp"
+#endif
@@ -0,0 +1,353 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+#include "Kernels.hpp"
+
+/** Calculates the gradient energy of a single pixel.
+
+    @param up
+    The row above, or the row itself for the first row.
+
+    @param cur
+    The row holding the pixel.
+
+    @param down
+    The row below, or the row itself for the last row.
+
+    @param w
+    The column of the pixel.
+
+    @param width
+    The number of pixels in the row.
+
+    @returns the energy of the pixel.
+ */
+template <typename P, typename E>
+  E GradientEnergy::energyAt(const P* up, const P* cur, const P* down, unsigned int w, unsigned int width) {
+    return energyAtScalar<P, E>(up, cur, down, w, width);
+  }
+
+/** Calculates a run of cells of a cost grid row, using gradient energy.
+
+    The energy of the run is calculated into the scratch row
+    by the vectorized energy kernel, one extra pixel either
+    side of the run supplying the neighbors of its ends, then
+    immediately consumed by the vectorized cost kernel.
+
+    @param up
+    The row above, or the row itself for the first row.
+
+    @param cur
+    The row of pixels the cost row belongs to.
+
+    @param down
+    The row below, or the row itself for the last row.
+
+    @param prev
+    The previous cost row, or nullptr for the first row.
+
+    @param out
+    The cost row to store the run in.
+
+    @param scratch
+    Space for a row of energy values.
+
+    @param first
+    The first column of the run.
+
+    @param last
+    One past the last column of the run.
+
+    @param width
+    The number of pixels in the row.
+ */
+template <typename P, typename E, typename C>
+  void GradientEnergy::costRun(const P* up, const P* cur, const P* down, const C* prev, C* out, E* scratch,
+                               unsigned int first, unsigned int last, unsigned int width) {
+    if (first >= last) {
+      return;
+    }
+
+    const unsigned int lo = first > 0 ? first - 1 : 0;
+    const unsigned int hi = last < width ? last + 1 : width;
+    energyRow(up + lo, cur + lo, down + lo, scratch + lo, hi - lo);
+
+    if (!prev) {
+      std::copy(scratch + first, scratch + last, out + first);
+      return;
+    }
+    costRow(scratch + first, prev + first, out + first, last - first, first == 0, last == width);
+  }
+
+/** Gets the extra cost of moving to each predecessor.
+
+    Gradient energy is independent of the path, so every
+    move is free.
+
+    @param costs
+    Set to the extra cost of moving to the left, center,
+    and right predecessor.
+ */
+template <typename P, typename C>
+  void GradientEnergy::moveCosts(const P*, const P*, unsigned int, unsigned int, C* costs) {
+    costs[0] = costs[1] = costs[2] = 0;
+  }
+
+/** Calculates the Sobel energy of a single pixel.
+
+    Pixels beyond the left and right edges repeat the
+    edge pixels.
+
+    @param up
+    The row above, or the row itself for the first row.
+
+    @param cur
+    The row holding the pixel.
+
+    @param down
+    The row below, or the row itself for the last row.
+
+    @param w
+    The column of the pixel.
+
+    @param width
+    The number of pixels in the row.
+
+    @returns the energy of the pixel.
+ */
+template <typename P, typename E>
+  E SobelEnergy::energyAt(const P* up, const P* cur, const P* down, unsigned int w, unsigned int width) {
+    const unsigned int l = w > 0 ? w - 1 : w;
+    const unsigned int r = w < width - 1 ? w + 1 : w;
+
+    const std::int64_t gx = (static_cast<std::int64_t>(up[r]) + 2 * cur[r] + down[r]) -
+                            (static_cast<std::int64_t>(up[l]) + 2 * cur[l] + down[l]);
+    const std::int64_t gy = (static_cast<std::int64_t>(down[l]) + 2 * down[w] + down[r]) -
+                            (static_cast<std::int64_t>(up[l]) + 2 * up[w] + up[r]);
+
+    // Halved, the largest value matches the largest gradient energy
+    return static_cast<E>((std::abs(gx) + std::abs(gy) + 1) / 2);
+  }
+
+/** Calculates a run of cells of a cost grid row, using Sobel energy.
+
+    The energy of the run is calculated into the scratch row,
+    then immediately consumed by the vectorized cost kernel.
+
+    @param up
+    The row above, or the row itself for the first row.
+
+    @param cur
+    The row of pixels the cost row belongs to.
+
+    @param down
+    The row below, or the row itself for the last row.
+
+    @param prev
+    The previous cost row, or nullptr for the first row.
+
+    @param out
+    The cost row to store the run in.
+
+    @param scratch
+    Space for a row of energy values.
+
+    @param first
+    The first column of the run.
+
+    @param last
+    One past the last column of the run.
+
+    @param width
+    The number of pixels in the row.
+ */
+template <typename P, typename E, typename C>
+  void SobelEnergy::costRun(const P* up, const P* cur, const P* down, const C* prev, C* out, E* scratch,
+                            unsigned int first, unsigned int last, unsigned int width) {
+    if (first >= last) {
+      return;
+    }
+
+    // Only the edge columns repeat their pixels, the columns
+    // between them are left to a branch free loop
+    const unsigned int lo = std::max(first, 1u);
+    const unsigned int hi = std::min(last, width - 1);
+    for (unsigned int w = first; w < std::min(lo, last); ++w) {
+      scratch[w] = energyAt<P, E>(up, cur, down, w, width);
+    }
+    for (unsigned int w = lo; w < hi; ++w) {
+      const int gx = (static_cast<int>(up[w + 1]) + 2 * cur[w + 1] + down[w + 1]) -
+                     (static_cast<int>(up[w - 1]) + 2 * cur[w - 1] + down[w - 1]);
+      const int gy = (static_cast<int>(down[w - 1]) + 2 * down[w] + down[w + 1]) -
+                     (static_cast<int>(up[w - 1]) + 2 * up[w] + up[w + 1]);
+      scratch[w] = static_cast<E>((std::abs(gx) + std::abs(gy) + 1) / 2);
+    }
+    for (unsigned int w = std::max(hi, lo); w < last; ++w) {
+      scratch[w] = energyAt<P, E>(up, cur, down, w, width);
+    }
+
+    if (!prev) {
+      std::copy(scratch + first, scratch + last, out + first);
+      return;
+    }
+    costRow(scratch + first, prev + first, out + first, last - first, first == 0, last == width);
+  }
+
+/** Gets the extra cost of moving to each predecessor.
+
+    Sobel energy is independent of the path, so every
+    move is free.
+
+    @param costs
+    Set to the extra cost of moving to the left, center,
+    and right predecessor.
+ */
+template <typename P, typename C>
+  void SobelEnergy::moveCosts(const P*, const P*, unsigned int, unsigned int, C* costs) {
+    costs[0] = costs[1] = costs[2] = 0;
+  }
+
+/** Calculates the forward energy every path through a pixel pays.
+
+    Removing a pixel always makes its left and right neighbors
+    adjacent, whichever way the seam continues. Pixels beyond
+    the left and right edges repeat the edge pixels.
+
+    @param cur
+    The row holding the pixel.
+
+    @param w
+    The column of the pixel.
+
+    @param width
+    The number of pixels in the row.
+
+    @returns the difference between the pixel's neighbors.
+ */
+template <typename P, typename E>
+  E ForwardEnergy::energyAt(const P*, const P* cur, const P*, unsigned int w, unsigned int width) {
+    const unsigned int l = w > 0 ? w - 1 : w;
+    const unsigned int r = w < width - 1 ? w + 1 : w;
+    return static_cast<E>(std::abs(static_cast<std::int64_t>(cur[r]) - cur[l]));
+  }
+
+/** Calculates a run of cells of a cost grid row, using forward energy.
+
+    Every cell pays the difference between its left and right
+    neighbors, and a diagonal move also pays the difference
+    between the pixel above and the neighbor on the side it
+    moves to, which become adjacent once the seam is removed.
+    The moves are folded into the minimum directly, so the
+    scratch row is unused.
+
+    @param up
+    The row above, or the row itself for the first row.
+
+    @param cur
+    The row of pixels the cost row belongs to.
+
+    @param prev
+    The previous cost row, or nullptr for the first row.
+
+    @param out
+    The cost row to store the run in.
+
+    @param first
+    The first column of the run.
+
+    @param last
+    One past the last column of the run.
+
+    @param width
+    The number of pixels in the row.
+ */
+template <typename P, typename E, typename C>
+  void ForwardEnergy::costRun(const P* up, const P* cur, const P*, const C* prev, C* out, E*,
+                              unsigned int first, unsigned int last, unsigned int width) {
+    if (!prev) {
+      for (unsigned int w = first; w < last; ++w) {
+        out[w] = energyAt<P, E>(up, cur, up, w, width);
+      }
+      return;
+    }
+
+    // Only the edge columns repeat their pixels, and lack
+    // a predecessor, the columns between them are left
+    // to a branch free loop
+    const unsigned int lo = std::max(first, 1u);
+    const unsigned int hi = std::min(last, width - 1);
+    auto edge = [&](unsigned int w) {
+      C costs[3];
+      moveCosts(up, cur, w, width, costs);
+      C minVal = prev[w];
+      if (w > 0) {
+        minVal = std::min<C>(minVal, prev[w - 1] + costs[0]);
+      }
+      if (w < width - 1) {
+        minVal = std::min<C>(minVal, prev[w + 1] + costs[2]);
+      }
+      out[w] = energyAt<P, E>(up, cur, up, w, width) + minVal;
+    };
+
+    for (unsigned int w = first; w < std::min(lo, last); ++w) {
+      edge(w);
+    }
+    for (unsigned int w = lo; w < hi; ++w) {
+      const C across = std::abs(static_cast<int>(cur[w + 1]) - cur[w - 1]);
+      const C left = prev[w - 1] + std::abs(static_cast<int>(up[w]) - cur[w - 1]);
+      const C right = prev[w + 1] + std::abs(static_cast<int>(up[w]) - cur[w + 1]);
+
+      // Selected rather than branched upon, as the cheapest
+      // move is unpredictable
+      C minVal = prev[w];
+      minVal = left < minVal ? left : minVal;
+      minVal = right < minVal ? right : minVal;
+      out[w] = across + minVal;
+    }
+    for (unsigned int w = std::max(hi, lo); w < last; ++w) {
+      edge(w);
+    }
+  }
+
+/** Gets the extra cost of moving to each predecessor.
+
+    @param up
+    The row above.
+
+    @param cur
+    The row of pixels the cell belongs to.
+
+    @param w
+    The column of the cell.
+
+    @param width
+    The number of pixels in the row.
+
+    @param costs
+    Set to the extra cost of moving to the left, center,
+    and right predecessor.
+ */
+template <typename P, typename C>
+  void ForwardEnergy::moveCosts(const P* up, const P* cur, unsigned int w, unsigned int width, C* costs) {
+    const unsigned int l = w > 0 ? w - 1 : w;
+    const unsigned int r = w < width - 1 ? w + 1 : w;
+    costs[0] = static_cast<C>(std::abs(static_cast<std::int64_t>(up[w]) - cur[l]));
+    costs[1] = 0;
+    costs[2] = static_cast<C>(std::abs(static_cast<std::int64_t>(up[w]) - cur[r]));
+  }
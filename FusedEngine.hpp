@@ -0,0 +1,64 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef FUSEDENGINE_HPP
+#define FUSEDENGINE_HPP
+
+#include <cstddef>
+#include <vector>
+
+#include "SeamCarver.hpp"
+#include "Util/FlexGrid.hpp"
+
+template <typename F, typename P, typename E = typename EnergyOf<P>::type,
+          typename C = typename CostOf<E>::type>
+class FusedEngine {
+  CarvingMode mode;
+  ThreadPool* pool;
+  FlexGrid<P> grid;
+  FlexGrid<P> spare;
+  FlexGrid<C> cost;
+  std::vector<unsigned int> seam;
+  std::vector<E> scratch;
+  std::vector<C> fresh;
+
+  std::size_t coneCells;
+  unsigned int sinceMeasured;
+  double removedEnergy;
+  unsigned int carvedSeams;
+public:
+  FusedEngine();
+  explicit FusedEngine(ThreadPool&);
+
+  void reset(const FlexGrid<P>&, const CarvingMode&);
+  void setMode(const CarvingMode&);
+
+  void removeSeam();
+  void removeSeams(const unsigned int&);
+
+  FlexGrid<P> getGrid() const;
+  double getRemovedEnergy() const;
+private:
+  void findSeam();
+  void recalculate();
+  void restart();
+
+  void updateCost();
+  bool useFullCost() const;
+  void changedBand(unsigned int, int&, int&) const;
+};
+
+#include "FusedEngine.ipp"
+#endif
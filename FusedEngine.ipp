@@ -0,0 +1,367 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "Util/Profiler.hpp"
+
+/** Construct a new FusedEngine object.
+
+    Constructs a new FusedEngine object, holding an
+    empty pixel grid, for usage with reset.
+ */
+template <typename F, typename P, typename E, typename C>
+  FusedEngine<F, P, E, C>::FusedEngine() :
+    mode(CarvingMode::VERTICAL),
+    pool(nullptr),
+    grid(0, 0),
+    spare(0, 0),
+    cost(0, 0),
+    coneCells(0),
+    sinceMeasured(0),
+    removedEnergy(0),
+    carvedSeams(0) { }
+
+/** Construct a new FusedEngine object.
+
+    Constructs a new FusedEngine object, holding an
+    empty pixel grid, for usage with reset, which splits
+    its cost grid calculations across the provided
+    thread pool.
+
+    @param pool
+    The thread pool to split calculations across, which
+    must outlive the engine.
+ */
+template <typename F, typename P, typename E, typename C>
+  FusedEngine<F, P, E, C>::FusedEngine(ThreadPool& pool) : FusedEngine() {
+    this->pool = &pool;
+  }
+
+/** Starts carving a new pixel grid.
+
+    Replaces the held pixel grid with a copy of the provided
+    grid, and recalculates its cost grid, reusing the memory
+    of both grids whenever it is large enough.
+
+    @param grid
+    The pixel grid to copy and remove seams from.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+ */
+template <typename F, typename P, typename E, typename C>
+  void FusedEngine<F, P, E, C>::reset(const FlexGrid<P>& grid, const CarvingMode& mode) {
+    this->mode = mode;
+    if (mode == CarvingMode::HORIZONTAL) {
+      transposeInto(grid, this->grid);
+    } else {
+      this->grid.assign(grid);
+    }
+    restart();
+  }
+
+/** Switches the carving mode, keeping the carved pixel grid.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+ */
+template <typename F, typename P, typename E, typename C>
+  void FusedEngine<F, P, E, C>::setMode(const CarvingMode& mode) {
+    if (mode == this->mode) {
+      return;
+    }
+    this->mode = mode;
+
+    transposeInto(grid, spare);
+    std::swap(grid, spare);
+    restart();
+  }
+
+/** Removes the seam of least significance.
+
+    Discovers the seam of least significance, removes it
+    from the pixel and cost grids, then refreshes only the
+    cost values the removal affected, calculating the
+    energy each of them needs on the way.
+ */
+template <typename F, typename P, typename E, typename C>
+  void FusedEngine<F, P, E, C>::removeSeam() {
+    if (grid.getWidth() < 1 || grid.getHeight() < 1) {
+      throw std::runtime_error("No seams left to remove!");
+    }
+
+    ProfileScope seamScope(Phase::SEAM, 0, carvedSeams);
+
+    {
+      ProfileScope scope(Phase::TRACEBACK, (grid.getWidth() + 3 * grid.getHeight()) * sizeof(C));
+      findSeam();
+    }
+    {
+      // Both grids move the cells right of the seam, only counted when profiling
+      ProfileScope scope(Phase::REMOVAL, 0);
+      if (Profiler::isEnabled()) {
+        std::size_t moved = 0;
+        for (unsigned int h = 0; h < grid.getHeight(); ++h) {
+          moved += grid.getWidth() - seam[h] - 1;
+        }
+        scope.addBytes(moved * (sizeof(P) + sizeof(C)));
+      }
+      compactSeamV(grid, seam);
+      compactSeamV(cost, seam);
+    }
+    ++carvedSeams;
+
+    if (useFullCost()) {
+      ProfileScope scope(Phase::COST, static_cast<std::size_t>(grid.getWidth()) * grid.getHeight() *
+                                      (sizeof(P) + sizeof(C)));
+      calcCostFused<F>(grid, cost, *pool);
+      ++sinceMeasured;
+    } else {
+      updateCost();
+      sinceMeasured = 0;
+    }
+  }
+
+/** Removes multiple seams of least significance.
+
+    @param amt
+    The amt of seams to remove.
+ */
+template <typename F, typename P, typename E, typename C>
+  void FusedEngine<F, P, E, C>::removeSeams(const unsigned int& amt) {
+    for (unsigned int i = 0; i < amt; ++i) {
+      removeSeam();
+    }
+  }
+
+/** Retrieves the carved pixel grid.
+
+    @returns the pixel grid, with all removed seams
+    removed, in its original orientation.
+ */
+template <typename F, typename P, typename E, typename C>
+  FlexGrid<P> FusedEngine<F, P, E, C>::getGrid() const {
+    return mode == CarvingMode::HORIZONTAL ? transpose(grid) : grid;
+  }
+
+/** Gets the total cost of every removed seam.
+
+    @returns the sum of the cost of every removed seam,
+    as measured by the energy function.
+ */
+template <typename F, typename P, typename E, typename C>
+  double FusedEngine<F, P, E, C>::getRemovedEnergy() const {
+    return removedEnergy;
+  }
+
+/** Discovers the seam of least significance.
+
+    Traces the path of least cost back up through the cost
+    grid, adding the energy function's cost of each move to
+    its predecessor's cost. Ties are resolved in the same
+    manner as CarvingEngine.
+ */
+template <typename F, typename P, typename E, typename C>
+  void FusedEngine<F, P, E, C>::findSeam() {
+    const unsigned int width = cost.getWidth();
+    const unsigned int height = cost.getHeight();
+
+    const C* last = cost.row(height - 1);
+    unsigned int next = 0;
+    if (mode == CarvingMode::VERTICAL) {
+      for (unsigned int w = width - 1; w + 1 > 0; --w) {
+        if (last[w] < last[next]) {
+          next = w;
+        }
+      }
+    } else {
+      for (unsigned int w = 0; w < width; ++w) {
+        if (last[w] < last[next]) {
+          next = w;
+        }
+      }
+    }
+    seam[height - 1] = next;
+    removedEnergy += last[next];
+
+    for (unsigned int h = height - 1; h > 0; --h) {
+      const C* prev = cost.row(h - 1);
+      C moves[3];
+      F::moveCosts(grid.row(h - 1), grid.row(h), next, width, moves);
+
+      const bool hasLeft = next > 0;
+      const bool hasRight = next < width - 1;
+      const C left = hasLeft ? prev[next - 1] + moves[0] : 0;
+      const C center = prev[next] + moves[1];
+      const C right = hasRight ? prev[next + 1] + moves[2] : 0;
+
+      C minVal = center;
+      if (hasLeft) {
+        minVal = std::min(minVal, left);
+      }
+      if (hasRight) {
+        minVal = std::min(minVal, right);
+      }
+
+      if (hasLeft && left == minVal) {
+        --next;
+      } else if (mode == CarvingMode::VERTICAL) {
+        next = center == minVal ? next : next + 1;
+      } else if (hasRight && right == minVal) {
+        ++next;
+      }
+      seam[h - 1] = next;
+    }
+  }
+
+/** Recalculates the cost grid from scratch.
+ */
+template <typename F, typename P, typename E, typename C>
+  void FusedEngine<F, P, E, C>::recalculate() {
+    ProfileScope scope(Phase::COST, static_cast<std::size_t>(grid.getWidth()) * grid.getHeight() *
+                                    (sizeof(P) + sizeof(C)));
+    if (pool) {
+      calcCostFused<F>(grid, cost, *pool);
+    } else {
+      calcCostFused<F>(grid, cost);
+    }
+  }
+
+/** Recalculates the cost grid, and clears all carving statistics.
+ */
+template <typename F, typename P, typename E, typename C>
+  void FusedEngine<F, P, E, C>::restart() {
+    recalculate();
+    seam.resize(grid.getHeight());
+    scratch.resize(grid.getWidth());
+    fresh.resize(grid.getWidth());
+    coneCells = 0;
+    sinceMeasured = 0;
+    removedEnergy = 0;
+    carvedSeams = 0;
+  }
+
+/** Refreshes the cost values affected by the removed seam.
+
+    Recalculates a row's costs only where the pixels its
+    energy is based on changed, or where the previous row's
+    costs changed, as CarvingEngine does. The costs of each
+    range are calculated into a spare row, so that only the
+    cells whose cost changed widen the next row's range.
+ */
+template <typename F, typename P, typename E, typename C>
+  void FusedEngine<F, P, E, C>::updateCost() {
+    const int width = cost.getWidth();
+    const unsigned int height = cost.getHeight();
+    ProfileScope scope(Phase::COST, 0);
+
+    // The range of the previous row whose cost changed,
+    // empty when lo > hi
+    int changedLo = 1;
+    int changedHi = 0;
+
+    coneCells = 0;
+
+    for (unsigned int h = 0; h < height; ++h) {
+      int lo, hi;
+      changedBand(h, lo, hi);
+      if (changedLo <= changedHi) {
+        lo = std::min(lo, changedLo - 1);
+        hi = std::max(hi, changedHi + 1);
+      }
+      lo = std::max(lo, 0);
+      hi = std::min(hi, width - 1);
+
+      changedLo = 1;
+      changedHi = 0;
+      if (lo > hi) {
+        continue;
+      }
+      coneCells += hi - lo + 1;
+
+      const P* cur  = grid.row(h);
+      const P* up   = h > 0          ? grid.row(h - 1) : cur;
+      const P* down = h < height - 1 ? grid.row(h + 1) : cur;
+      F::costRun(up, cur, down, h > 0 ? cost.row(h - 1) : nullptr, fresh.data(), scratch.data(),
+                 lo, hi + 1, width);
+
+      C* out = cost.row(h);
+      for (int w = lo; w <= hi; ++w) {
+        if (fresh[w] != out[w]) {
+          out[w] = fresh[w];
+          if (changedLo > changedHi) {
+            changedLo = w;
+          }
+          changedHi = w;
+        }
+      }
+    }
+    scope.addBytes(coneCells * (sizeof(P) + sizeof(C)));
+  }
+
+/** Decides whether to recalculate the whole cost grid.
+
+    Follows the same measure as CarvingEngine, comparing the
+    cone of affected cells, split over the pool's threads,
+    against the whole grid.
+
+    @returns true if the whole cost grid should be
+    recalculated across the thread pool.
+ */
+template <typename F, typename P, typename E, typename C>
+  bool FusedEngine<F, P, E, C>::useFullCost() const {
+    const unsigned int REMEASURE = 32;
+
+    if (!pool || pool->size() < 2 || sinceMeasured >= REMEASURE) {
+      return false;
+    }
+    const std::size_t cells = static_cast<std::size_t>(cost.getWidth()) * cost.getHeight();
+    return coneCells * pool->size() > 2 * cells;
+  }
+
+/** Finds the cells of a row whose cost the removed seam directly affected.
+
+    Every energy function reads at most the 3x3 block of pixels
+    around a cell, whose pixels only change between the seam's
+    positions in the adjacent rows, and directly beside the seam.
+    Cells whose predecessors shifted lie within the same range.
+
+    @param h
+    The row to examine.
+
+    @param lo
+    Set to the first affected column.
+
+    @param hi
+    Set to the last affected column, lo > hi if
+    no column is affected.
+ */
+template <typename F, typename P, typename E, typename C>
+  void FusedEngine<F, P, E, C>::changedBand(unsigned int h, int& lo, int& hi) const {
+    int sMin = seam[h];
+    int sMax = seam[h];
+    if (h > 0) {
+      sMin = std::min<int>(sMin, seam[h - 1]);
+      sMax = std::max<int>(sMax, seam[h - 1]);
+    }
+    if (h < grid.getHeight() - 1) {
+      sMin = std::min<int>(sMin, seam[h + 1]);
+      sMax = std::max<int>(sMax, seam[h + 1]);
+    }
+    lo = std::max(sMin - 1, 0);
+    hi = std::min<int>(sMax, grid.getWidth() - 1);
+  }
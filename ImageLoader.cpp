@@ -16,42 +16,202 @@
 #include "ImageLoader.hpp"
 
 #include <algorithm>
-#include <fstream>
-#include <regex>
+#include <limits>
 #include <stdexcept>
+#include <vector>
+
+#include "Util/MappedFile.hpp"
+#include "Util/Profiler.hpp"
+
+namespace {
+
+/** Checks to see if a character is PGM whitespace.
+
+    @param c
+    The character to check.
+
+    @returns true if the character is whitespace.
+ */
+inline bool isSpace(char c) {
+  return c == ' ' || c == '\n' || c == '\r' || c == '\t' || c == '\v' || c == '\f';
+}
+
+/** Skips past whitespace and comments.
+
+    PGM comments run from a '#' to the end of the line,
+    and may appear anywhere whitespace may.
+
+    @param pos
+    The current position, advanced to the next token.
+
+    @param end
+    The end of the data.
+ */
+inline void skipSpace(const char*& pos, const char* end) {
+  while (pos < end) {
+    if (isSpace(*pos)) {
+      ++pos;
+    } else if (*pos == '#') {
+      while (pos < end && *pos != '\n') {
+        ++pos;
+      }
+    } else {
+      break;
+    }
+  }
+}
+
+/** Reads a decimal number.
+
+    @param pos
+    The current position, advanced past the number.
+
+    @param end
+    The end of the data.
+
+    @param max
+    The largest number which may be read.
+
+    @param val
+    Set to the number read, or -1 if it exceeds max.
+
+    @returns true if a number was read.
+ */
+inline bool readNumber(const char*& pos, const char* end, int max, int& val) {
+  skipSpace(pos, end);
+  if (pos == end || *pos < '0' || *pos > '9') {
+    return false;
+  }
+  val = 0;
+  while (pos < end && *pos >= '0' && *pos <= '9') {
+    const int digit = *pos++ - '0';
+    // Checked before multiplying, so val never overflows
+    if (val < 0 || digit > max || val > (max - digit) / 10) {
+      val = -1;
+    } else {
+      val = val * 10 + digit;
+    }
+  }
+  return true;
+}
+
+/** Reads every sample of an ASCII (P2) PGM body into a pixel grid.
+
+    @param pos
+    The first byte of the body.
+
+    @param end
+    The end of the data.
+
+    @param greyScale
+    The largest value a sample may hold.
+
+    @param grid
+    The pixel grid to fill, of the image's deminsions.
+ */
+template <typename P>
+void readAsciiSamples(const char* pos, const char* end, int greyScale, FlexGrid<P>& grid) {
+  for (unsigned int row = 0; row < grid.getHeight(); ++row) {
+    P* out = grid.row(row);
+    for (unsigned int col = 0; col < grid.getWidth(); ++col) {
+      int val;
+      if (!readNumber(pos, end, greyScale, val)) {
+        throw std::runtime_error("Invalid PGM data (not enough data to fill all columns and rows)!");
+      }
+      if (val < 0) {
+        throw std::runtime_error("Invalid PGM data (sample exceeds the grey scale value)!");
+      }
+      out[col] = static_cast<P>(val);
+    }
+  }
+}
+
+/** Writes every sample of a pixel grid as an ASCII (P2) PGM body.
+
+    Writes 15 samples per line.
+
+    @param out
+    The writer to add data to.
+
+    @param grid
+    The pixel grid to write.
+ */
+template <typename P>
+void writeAsciiSamples(BufferedWriter& out, const FlexGrid<P>& grid) {
+  int entries = 0;
+  for (unsigned int line = 0; line < grid.getHeight(); ++line) {
+    const P* in = grid.row(line);
+    for (unsigned int col = 0; col < grid.getWidth(); ++col) {
+      out.putUInt(in[col]);
+      out.put(' ');
+      if (++entries == 15) {
+        entries = 0;
+        out.put('\n');
+      }
+    }
+  }
+}
+
+}
 
 /** Construct a new ImageLoader object.
 
     Constructs a new ImageLoader object, which
     no relationship to any image.
  */
-ImageLoader::ImageLoader() : iData(0, 0) { }
+ImageLoader::ImageLoader() :
+  greyScale(0), rowCount(0), colCount(0), format(PgmFormat::ASCII), narrowData(0, 0), wideData(0, 0) { }
+
+/** Retrieves the width of the image.
+
+    @returns the number of columns.
+ */
+int ImageLoader::getWidth() const {
+  return colCount;
+}
 
-/** Retrives the stored pixel grid.
+/** Retrieves the height of the image.
+
+    @returns the number of rows.
+ */
+int ImageLoader::getHeight() const {
+  return rowCount;
+}
+
+/** Retrieves the grey scale value of the image.
+
+    @returns the largest value a pixel may hold.
+ */
+int ImageLoader::getGreyScale() const {
+  return greyScale;
+}
 
-    Retrieves the stored pixel grid,
-    or an empty pixel grid if there is not
-    an established relationship to any image.
+/** Checks whether pixels are stored in 16 bits.
 
-    @returns the stored pixel grid.
+    @returns true if the grey scale value is above 255,
+    false if pixels are stored in 8 bits.
  */
-FlexGrid<int> ImageLoader::getGrid() const {
-  return iData;
+bool ImageLoader::isWide() const {
+  return greyScale > 255;
 }
 
-/** Replaces the stored pixel grid.
+/** Retrieves the format files are exported in.
 
-    Sets the stored pixel grid, to the provided grid,
-    and updates all related demensional measures.
+    Defaults to the format of the last loaded file.
 
-    @param iData
-    The pixel grid which shall replace the current
-    pixel grid.
+    @returns the export format.
  */
-void ImageLoader::setGrid(const FlexGrid<int>& iData) {
-  this->iData = iData;
-  this->colCount = iData.getWidth();
-  this->rowCount = iData.getHeight();
+PgmFormat ImageLoader::getFormat() const {
+  return format;
+}
+
+/** Sets the format files are exported in.
+
+    @param format
+    The new export format, ASCII (P2) or BINARY (P5).
+ */
+void ImageLoader::setFormat(const PgmFormat& format) {
+  this->format = format;
 }
 
 /** Loads a PGM image file.
@@ -61,6 +221,10 @@ void ImageLoader::setGrid(const FlexGrid<int>& iData) {
     that of the new image, establishing a relationship
     between the ImageLoader, and the image.
 
+    Both ASCII (P2) and binary (P5) files are supported.
+    The file is memory mapped, rather than read through
+    a stream.
+
     If the image loading process fails, and throws
     an exception, the ImageLoader's current
     state -- and therefor data -- must be considered
@@ -70,34 +234,74 @@ void ImageLoader::setGrid(const FlexGrid<int>& iData) {
     The PGM file which shall be processed.
  */
 void ImageLoader::loadFile(const std::string& path) {
-  std::ifstream ifs(path);
-  parseHeader(ifs);
-  parseBody(ifs);
+  ProfileScope scope(Phase::LOAD, 0);
+  MappedFile file(path);
+  scope.addBytes(file.end() - file.begin());
+  const char* pos = file.begin();
+  parseHeader(pos, file.end());
+  parseBody(pos, file.end());
+}
+
+/** Loads only the header of a PGM image file.
+
+    Updates the ImageLoader's deminsions, grey scale value,
+    and format to match those of the image, without reading
+    its pixels, so that the body may be streamed separately.
+    The pixel grid is left untouched.
+
+    @param path
+    The PGM file which shall be processed.
+
+    @returns the offset of the first byte of the body.
+ */
+std::size_t ImageLoader::loadHeader(const std::string& path) {
+  MappedFile file(path);
+  const char* pos = file.begin();
+  parseHeader(pos, file.end());
+  return pos - file.begin();
 }
 
-/** Checks to see if a line is a comment line.
+/** Loads the next image of a multi-image PGM stream.
+
+    Binary (P5) images may be concatenated into a single
+    stream, each image immediately following the last row of
+    the image before it, as with video frames. Plain (P2)
+    images can only be the last image of a stream.
 
-    Uses regex to check to see if a given string
-    matches the format of a PGM comment.
+    @param pos
+    The position of the next image within the stream's data,
+    advanced past the loaded image.
 
-    @param str
-    The string to check
+    @param end
+    The end of the stream's data.
 
-    @returns true if the provided string indeed
-    matches the formate of a PGM comment line.
+    @returns true if an image was loaded, false if only
+    whitespace and comments remained.
  */
-bool ImageLoader::isComment(const std::string& str) {
-  const std::regex e("(#)(.*)");
+bool ImageLoader::loadNext(const char*& pos, const char* end) {
+  skipSpace(pos, end);
+  if (pos == end) {
+    return false;
+  }
 
-  return std::regex_match(str, e);
+  ProfileScope scope(Phase::LOAD, 0);
+  const char* start = pos;
+  parseHeader(pos, end);
+  parseBody(pos, end);
+  if (format == PgmFormat::ASCII) {
+    pos = end;
+  } else {
+    pos += (greyScale < 256 ? 1 : 2) * static_cast<std::size_t>(colCount) * rowCount;
+  }
+  scope.addBytes(pos - start);
+  return true;
 }
 
 /** Parses the header portion of a PGM file.
 
-    Given an input file stream, this function
-    removes lines from the file stream until all header
-    information is gathered, or the file is deemed
-    invalid. Header information will be updated
+    Given the file's data, this function reads tokens
+    until all header information is gathered, or the file
+    is deemed invalid. Header information will be updated
     in the ImageLoader as it is obtained.
 
     If the header processing fails, and throws
@@ -105,155 +309,239 @@ bool ImageLoader::isComment(const std::string& str) {
     state -- and therefor data -- must be considered
     invalid.
 
-    @param ifs
-    The input file stream to pull lines from.
- */
-void ImageLoader::parseHeader(std::ifstream& ifs) {
-  // Regex constants
-  const std::regex pattern("[0-9]+");
-  const std::regex_token_iterator<std::string::iterator> rend;
+    @param pos
+    The start of the file's data, advanced to the
+    first byte of the body.
 
+    @param end
+    The end of the file's data.
+ */
+void ImageLoader::parseHeader(const char*& pos, const char* end) {
   // Get PGM Header
-  do {
-    std::getline(ifs, header);
-  } while (isComment(header));
-
-  std::string temp;
-
-  // Get size line
-  do {
-    std::getline(ifs, temp);
-  } while (isComment(temp));
-
-  std::regex_token_iterator<std::string::iterator> sizeMatch(
-    temp.begin(), temp.end(), pattern
-  );
+  skipSpace(pos, end);
+  if (end - pos < 2 || pos[0] != 'P' || (pos[1] != '2' && pos[1] != '5')) {
+    throw std::runtime_error("PGM file header invalid (only P2 and P5 are supported)!");
+  }
+  format = pos[1] == '2' ? PgmFormat::ASCII : PgmFormat::BINARY;
+  pos += 2;
 
-  if (std::distance(sizeMatch, rend) != 2) {
+  // Get size
+  const int MAX = std::numeric_limits<int>::max();
+  if (!readNumber(pos, end, MAX, colCount) || !readNumber(pos, end, MAX, rowCount) ||
+      colCount < 0 || rowCount < 0) {
     throw std::runtime_error("PGM file deminisions invalid!");
   }
 
-  colCount = std::atoi((*(sizeMatch++)).str().c_str());
-  rowCount = std::atoi((*(sizeMatch++)).str().c_str());
-
-  // Get grey scale line
-  do {
-    std::getline(ifs, temp);
-  } while (isComment(temp));
-
-  std::regex_token_iterator<std::string::iterator> greyScaleMatch(
-    temp.begin(), temp.end(), pattern
-  );
-
-  if (std::distance(greyScaleMatch, rend) != 1) {
+  // Grey scale
+  if (!readNumber(pos, end, 65535, greyScale) || greyScale < 1) {
     throw std::runtime_error("PGM file grey scale value invalid!");
   }
 
-  // Grey scale
-  greyScale = std::atoi((*(greyScaleMatch++)).str().c_str());
+  // A single whitespace character separates the
+  // header from the body
+  if (pos == end || !isSpace(*pos)) {
+    throw std::runtime_error("PGM file grey scale value invalid!");
+  }
+  ++pos;
 }
 
 /** Parses the body portion of a PGM file.
 
-    Given an input file stream, this function
-    removes lines from the file stream until all cells
-    of the pixel grid have been filled,
-    or the file is deemed invalid.
+    Given the file's data following the header, this
+    function fills all cells of the pixel grid, or the
+    file is deemed invalid.
 
     If the body processing fails, and throws
     an exception, the ImageLoader's current
     state -- and therefor data -- must be considered
     invalid.
 
-    @param ifs
-    The input file stream to pull lines from.
+    @param pos
+    The first byte of the body.
+
+    @param end
+    The end of the file's data.
  */
-void ImageLoader::parseBody(std::ifstream& ifs) {
+void ImageLoader::parseBody(const char* pos, const char* end) {
+  // Only the grid matching the pixel size holds data
+  narrowData = FlexGrid<std::uint8_t>(isWide() ? 0 : colCount, isWide() ? 0 : rowCount);
+  wideData = FlexGrid<std::uint16_t>(isWide() ? colCount : 0, isWide() ? rowCount : 0);
+
+  switch (format) {
+    case PgmFormat::ASCII:
+      parseAsciiBody(pos, end);
+      return;
+    case PgmFormat::BINARY:
+      parseBinaryBody(pos, end);
+      return;
+  }
+}
+
+/** Parses the body portion of an ASCII (P2) PGM file.
 
-  const std::regex pattern("[0-9]+");
-  const std::regex_token_iterator<std::string::iterator> rend;
+    Reads each whitespace separated sample straight
+    into the pixel grid.
 
-  iData = FlexGrid<int>(colCount, rowCount);
+    @param pos
+    The first byte of the body.
 
-  std::vector<int> rowData;
+    @param end
+    The end of the file's data.
+ */
+void ImageLoader::parseAsciiBody(const char* pos, const char* end) {
+  if (isWide()) {
+    readAsciiSamples(pos, end, greyScale, wideData);
+  } else {
+    readAsciiSamples(pos, end, greyScale, narrowData);
+  }
+}
 
-  while (!ifs.eof()) {
-    std::string line;
-    std::getline(ifs, line);
+/** Parses the body portion of a binary (P5) PGM file.
 
-    if (isComment(line)) continue;
+    Samples are copied straight from the file into
+    the pixel grid, as single bytes when the grey scale
+    value is below 256, or as big endian byte pairs
+    otherwise.
 
-    std::regex_token_iterator<std::string::iterator> match(
-      line.begin(), line.end(), pattern
-    );
+    @param pos
+    The first byte of the body.
 
-    while (match != rend) {
-      rowData.push_back(std::atoi((*(match++)).str().c_str()));
-    }
+    @param end
+    The end of the file's data.
+ */
+void ImageLoader::parseBinaryBody(const char* pos, const char* end) {
+  const std::size_t sampleSize = greyScale < 256 ? 1 : 2;
+  const std::size_t rowSize = sampleSize * colCount;
+  if (static_cast<std::size_t>(end - pos) < rowSize * rowCount) {
+    throw std::runtime_error("Invalid PGM data (not enough data to fill all columns and rows)!");
   }
 
-  try {
-    for (int row = 0; row < rowCount; ++row) {
+  const unsigned char* in = reinterpret_cast<const unsigned char*>(pos);
+  for (int row = 0; row < rowCount; ++row, in += rowSize) {
+    if (sampleSize == 1) {
+      std::copy(in, in + colCount, narrowData.row(row));
+    } else {
+      std::uint16_t* out = wideData.row(row);
       for (int col = 0; col < colCount; ++col) {
-        iData.setValAt(col, row, rowData.at((row * colCount) + col));
+        out[col] = static_cast<std::uint16_t>((in[2 * col] << 8) | in[2 * col + 1]);
       }
     }
-  } catch (...) {
-    throw std::runtime_error("Invalid PGM data (not enough data to fill all columns and rows)!");
   }
 }
 
 /** Exports the current stored pixel grid as a PGM file.
 
     Given an output file path, takes the current
-    stored pixel grid, and exports it as a PGM file.
+    stored pixel grid, and exports it as a PGM file,
+    in the current export format.
 
     @param path
     The file which shall be exported to.
  */
 void ImageLoader::exportFile(const std::string& path) const {
-  std::ofstream ofs(path);
-  exportHeader(ofs, path);
-  exportBody(ofs);
+  ProfileScope scope(Phase::EXPORT, (isWide() ? 2 : 1) * static_cast<std::size_t>(colCount) * rowCount);
+  BufferedWriter out(path);
+  exportHeader(out, path);
+  exportBody(out);
+  out.close();
+}
+
+/** Appends the current stored pixel grid to a PGM stream.
+
+    Exports the header and body in the current export
+    format, so that several images may be written into the
+    same multi-image stream.
+
+    @param out
+    The writer to add data to.
+
+    @param name
+    The name recorded in the image's header comment.
+ */
+void ImageLoader::exportInto(BufferedWriter& out, const std::string& name) const {
+  ProfileScope scope(Phase::EXPORT, (isWide() ? 2 : 1) * static_cast<std::size_t>(colCount) * rowCount);
+  exportHeader(out, name);
+  exportBody(out);
 }
 
 /** Exports the header of the pixel grid into a PGM file.
 
     Exports the PGM file header data using the
-    provided ofs, and resulting new file name.
+    provided writer, and resulting new file name.
 
-    @param ofs
-    The output file stream to add data to.
+    @param out
+    The writer to add data to.
 
     @param nFileName
     The name of the new file.
  */
-void ImageLoader::exportHeader(std::ofstream& ofs, const std::string& nFileName) const {
-  ofs << header << std::endl;
-  ofs << "# " << nFileName << std::endl;
-  ofs << colCount << ' ' << rowCount << std::endl;
-  ofs << greyScale << std::endl;
+void ImageLoader::exportHeader(BufferedWriter& out, const std::string& nFileName) const {
+  out.putStr(format == PgmFormat::ASCII ? "P2\n" : "P5\n");
+  out.putStr("# " + nFileName + "\n");
+  out.putUInt(colCount);
+  out.put(' ');
+  out.putUInt(rowCount);
+  out.put('\n');
+  out.putUInt(greyScale);
+  out.put('\n');
 }
 
 /** Exports the body of the pixel grid into a PGM file.
 
     Exports the PGM file pixel data using the
-    provided ofs.
+    provided writer.
 
-    @param ofs
-    The output file stream to add data to.
+    @param out
+    The writer to add data to.
  */
-void ImageLoader::exportBody(std::ofstream& ofs) const {
-  int entries = 0;
+void ImageLoader::exportBody(BufferedWriter& out) const {
+  switch (format) {
+    case PgmFormat::ASCII:
+      exportAsciiBody(out);
+      return;
+    case PgmFormat::BINARY:
+      exportBinaryBody(out);
+      return;
+  }
+}
+
+/** Exports the body of the pixel grid into an ASCII (P2) PGM file.
+
+    Writes 15 samples per line.
+
+    @param out
+    The writer to add data to.
+ */
+void ImageLoader::exportAsciiBody(BufferedWriter& out) const {
+  if (isWide()) {
+    writeAsciiSamples(out, wideData);
+  } else {
+    writeAsciiSamples(out, narrowData);
+  }
+}
+
+/** Exports the body of the pixel grid into a binary (P5) PGM file.
+
+    Writes each sample as a single byte when the grey scale
+    value is below 256, or as a big endian byte pair otherwise.
+
+    @param out
+    The writer to add data to.
+ */
+void ImageLoader::exportBinaryBody(BufferedWriter& out) const {
+  const std::size_t sampleSize = greyScale < 256 ? 1 : 2;
+  std::vector<unsigned char> rowData(sampleSize * colCount);
   for (int line = 0; line < rowCount; ++line) {
-    for (int col = 0; col < colCount; ++col) {
-      ofs << iData.getValAt(col, line);
-      if (++entries == 15) {
-        entries = 0;
-        ofs << " " << std::endl;
-        continue;
+    if (sampleSize == 1) {
+      const std::uint8_t* in = narrowData.row(line);
+      std::copy(in, in + colCount, rowData.begin());
+    } else {
+      const std::uint16_t* in = wideData.row(line);
+      for (int col = 0; col < colCount; ++col) {
+        rowData[2 * col] = static_cast<unsigned char>(in[col] >> 8);
+        rowData[2 * col + 1] = static_cast<unsigned char>(in[col]);
       }
-      ofs << ' ';
     }
+    out.write(reinterpret_cast<const char*>(rowData.data()), rowData.size());
   }
 }
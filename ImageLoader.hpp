@@ -16,32 +16,60 @@
 #ifndef IMAGELOADER_HPP
 #define IMAGELOADER_HPP
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
+#include "Util/BufferedWriter.hpp"
 #include "Util/FlexGrid.hpp"
 
+enum class PgmFormat {
+  ASCII,
+  BINARY
+};
+
 class ImageLoader {
-    std::string header;
     int greyScale;
 
     int rowCount;
     int colCount;
-    FlexGrid<int> iData;
+    PgmFormat format;
+    FlexGrid<std::uint8_t> narrowData;
+    FlexGrid<std::uint16_t> wideData;
 public:
     ImageLoader();
 
-    FlexGrid<int> getGrid() const;
-    void setGrid(const FlexGrid<int>&);
+    template <typename P = int>
+      FlexGrid<P> getGrid() const;
+    template <typename P>
+      void setGrid(const FlexGrid<P>&);
+    template <typename M>
+      FlexGrid<M> getMask(const M&) const;
+
+    int getWidth() const;
+    int getHeight() const;
+    int getGreyScale() const;
+    bool isWide() const;
+
+    PgmFormat getFormat() const;
+    void setFormat(const PgmFormat&);
 
     void loadFile(const std::string&);
+    std::size_t loadHeader(const std::string&);
+    bool loadNext(const char*&, const char*);
     void exportFile(const std::string&) const;
+    void exportInto(BufferedWriter&, const std::string&) const;
 private:
-    bool isComment(const std::string&);
-
-    void parseHeader(std::ifstream&);
-    void parseBody(std::ifstream&);
+    void parseHeader(const char*&, const char*);
+    void parseBody(const char*, const char*);
+    void parseAsciiBody(const char*, const char*);
+    void parseBinaryBody(const char*, const char*);
 
-    void exportHeader(std::ofstream&, const std::string&) const;
-    void exportBody(std::ofstream&) const;
+    void exportHeader(BufferedWriter&, const std::string&) const;
+    void exportBody(BufferedWriter&) const;
+    void exportAsciiBody(BufferedWriter&) const;
+    void exportBinaryBody(BufferedWriter&) const;
 };
+
+#include "ImageLoader.ipp"
 #endif
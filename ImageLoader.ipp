@@ -0,0 +1,94 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+
+/** Retrives the stored pixel grid.
+
+    Retrieves a copy of the stored pixel grid, converted
+    to the requested pixel type, or an empty pixel grid if
+    there is not an established relationship to any image.
+    Pixels are stored in 8 bits when the grey scale value
+    is below 256, and 16 bits otherwise, so requesting
+    that type avoids widening every pixel.
+
+    @returns the stored pixel grid.
+ */
+template <typename P>
+  FlexGrid<P> ImageLoader::getGrid() const {
+    return isWide() ? convertGrid<P>(wideData) : convertGrid<P>(narrowData);
+  }
+
+/** Replaces the stored pixel grid.
+
+    Sets the stored pixel grid, to the provided grid,
+    and updates all related demensional measures. Pixels
+    must not exceed the grey scale value, which is taken
+    from the grid's largest pixel if no image has been
+    loaded yet.
+
+    @param iData
+    The pixel grid which shall replace the current
+    pixel grid.
+ */
+template <typename P>
+  void ImageLoader::setGrid(const FlexGrid<P>& iData) {
+    if (greyScale < 1) {
+      greyScale = 1;
+      for (unsigned int h = 0; h < iData.getHeight(); ++h) {
+        const P* row = iData.row(h);
+        for (unsigned int w = 0; w < iData.getWidth(); ++w) {
+          greyScale = std::max<int>(greyScale, row[w]);
+        }
+      }
+      greyScale = std::min(greyScale, 65535);
+    }
+
+    this->colCount = iData.getWidth();
+    this->rowCount = iData.getHeight();
+    if (isWide()) {
+      wideData = convertGrid<std::uint16_t>(iData);
+      narrowData = FlexGrid<std::uint8_t>(0, 0);
+    } else {
+      narrowData = convertGrid<std::uint8_t>(iData);
+      wideData = FlexGrid<std::uint16_t>(0, 0);
+    }
+  }
+
+/** Retrives the stored image as a mask.
+
+    Marks every pixel brighter than half the grey scale
+    value, so that masks drawn with soft edges are still
+    read as the shape drawn.
+
+    @param marked
+    The cell of every marked pixel, every other pixel
+    holding a value initialized cell.
+
+    @returns a mask of equal deminsions to the image.
+ */
+template <typename M>
+  FlexGrid<M> ImageLoader::getMask(const M& marked) const {
+    const FlexGrid<int> pixels = getGrid<int>();
+    FlexGrid<M> r(pixels.getWidth(), pixels.getHeight());
+    for (unsigned int h = 0; h < pixels.getHeight(); ++h) {
+      const int* in = pixels.row(h);
+      M* out = r.row(h);
+      for (unsigned int w = 0; w < pixels.getWidth(); ++w) {
+        out[w] = 2 * in[w] > greyScale ? marked : M();
+      }
+    }
+    return r;
+  }
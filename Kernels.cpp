@@ -0,0 +1,532 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "Kernels.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define KERNELS_X86
+#include <immintrin.h>
+#endif
+
+namespace {
+
+/** Detects the widest instruction set the running CPU supports.
+
+    @returns the detected SIMD level.
+ */
+SimdLevel detectSimdLevel() {
+#ifdef KERNELS_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx2")) {
+    return SimdLevel::AVX2;
+  }
+  if (__builtin_cpu_supports("sse2")) {
+    return SimdLevel::SSE2;
+  }
+#endif
+  return SimdLevel::SCALAR;
+}
+
+const SimdLevel supportedLevel = detectSimdLevel();
+SimdLevel activeLevel = supportedLevel;
+
+#ifdef KERNELS_X86
+
+#define TARGET_SSE2 __attribute__((target("sse2")))
+#define TARGET_AVX2 __attribute__((target("avx2")))
+
+// SSE2 lacks absolute difference and 32 bit minimum instructions,
+// these helpers build them out of the instructions it does have
+
+TARGET_SSE2 inline __m128i absDiffEpu8(__m128i a, __m128i b) {
+  return _mm_or_si128(_mm_subs_epu8(a, b), _mm_subs_epu8(b, a));
+}
+
+TARGET_SSE2 inline __m128i absDiffEpu16(__m128i a, __m128i b) {
+  return _mm_or_si128(_mm_subs_epu16(a, b), _mm_subs_epu16(b, a));
+}
+
+TARGET_SSE2 inline __m128i absEpi32(__m128i a) {
+  const __m128i sign = _mm_srai_epi32(a, 31);
+  return _mm_sub_epi32(_mm_xor_si128(a, sign), sign);
+}
+
+TARGET_SSE2 inline __m128i minEpi32(__m128i a, __m128i b) {
+  const __m128i mask = _mm_cmpgt_epi32(a, b);
+  return _mm_or_si128(_mm_and_si128(mask, b), _mm_andnot_si128(mask, a));
+}
+
+TARGET_SSE2 inline __m128i minEpu32(__m128i a, __m128i b) {
+  const __m128i bias = _mm_set1_epi32(static_cast<int>(0x80000000u));
+  return _mm_xor_si128(minEpi32(_mm_xor_si128(a, bias), _mm_xor_si128(b, bias)), bias);
+}
+
+TARGET_AVX2 inline __m256i absDiffEpu8(__m256i a, __m256i b) {
+  return _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a));
+}
+
+TARGET_AVX2 inline __m256i absDiffEpu16(__m256i a, __m256i b) {
+  return _mm256_or_si256(_mm256_subs_epu16(a, b), _mm256_subs_epu16(b, a));
+}
+
+// Energy kernels, every kernel calculates the first pixel, and the
+// pixels past the last full vector, using the scalar kernel, so
+// that loads never stray past either end of a row
+
+TARGET_SSE2 void energyRowSse2(const std::uint8_t* up, const std::uint8_t* cur, const std::uint8_t* down,
+                        std::uint16_t* out, unsigned int width) {
+  if (width < 2) {
+    energyRowScalar(up, cur, down, out, width);
+    return;
+  }
+  out[0] = energyAtScalar<std::uint8_t, std::uint16_t>(up, cur, down, 0, width);
+
+  const __m128i zero = _mm_setzero_si128();
+  unsigned int w = 1;
+  for (; w + 16 <= width - 1; w += 16) {
+    const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + w));
+    const __m128i l = absDiffEpu8(c, _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + w - 1)));
+    const __m128i r = absDiffEpu8(c, _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + w + 1)));
+    const __m128i t = absDiffEpu8(c, _mm_loadu_si128(reinterpret_cast<const __m128i*>(up + w)));
+    const __m128i b = absDiffEpu8(c, _mm_loadu_si128(reinterpret_cast<const __m128i*>(down + w)));
+
+    // Widen to 16 bits before summing, as the sum of four
+    // differences may exceed 8 bits
+    const __m128i lo = _mm_add_epi16(
+      _mm_add_epi16(_mm_unpacklo_epi8(l, zero), _mm_unpacklo_epi8(r, zero)),
+      _mm_add_epi16(_mm_unpacklo_epi8(t, zero), _mm_unpacklo_epi8(b, zero)));
+    const __m128i hi = _mm_add_epi16(
+      _mm_add_epi16(_mm_unpackhi_epi8(l, zero), _mm_unpackhi_epi8(r, zero)),
+      _mm_add_epi16(_mm_unpackhi_epi8(t, zero), _mm_unpackhi_epi8(b, zero)));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + w), lo);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + w + 8), hi);
+  }
+  for (; w < width; ++w) {
+    out[w] = energyAtScalar<std::uint8_t, std::uint16_t>(up, cur, down, w, width);
+  }
+}
+
+TARGET_AVX2 void energyRowAvx2(const std::uint8_t* up, const std::uint8_t* cur, const std::uint8_t* down,
+                        std::uint16_t* out, unsigned int width) {
+  if (width < 2) {
+    energyRowScalar(up, cur, down, out, width);
+    return;
+  }
+  out[0] = energyAtScalar<std::uint8_t, std::uint16_t>(up, cur, down, 0, width);
+
+  unsigned int w = 1;
+  for (; w + 32 <= width - 1; w += 32) {
+    const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur + w));
+    const __m256i l = absDiffEpu8(c, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur + w - 1)));
+    const __m256i r = absDiffEpu8(c, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur + w + 1)));
+    const __m256i t = absDiffEpu8(c, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(up + w)));
+    const __m256i b = absDiffEpu8(c, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(down + w)));
+
+    // Widen each half to 16 bits before summing, as the sum of
+    // four differences may exceed 8 bits
+    const __m256i lo = _mm256_add_epi16(
+      _mm256_add_epi16(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(l)),
+                       _mm256_cvtepu8_epi16(_mm256_castsi256_si128(r))),
+      _mm256_add_epi16(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(t)),
+                       _mm256_cvtepu8_epi16(_mm256_castsi256_si128(b))));
+    const __m256i hi = _mm256_add_epi16(
+      _mm256_add_epi16(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(l, 1)),
+                       _mm256_cvtepu8_epi16(_mm256_extracti128_si256(r, 1))),
+      _mm256_add_epi16(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(t, 1)),
+                       _mm256_cvtepu8_epi16(_mm256_extracti128_si256(b, 1))));
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + w), lo);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + w + 16), hi);
+  }
+  for (; w < width; ++w) {
+    out[w] = energyAtScalar<std::uint8_t, std::uint16_t>(up, cur, down, w, width);
+  }
+}
+
+TARGET_SSE2 void energyRowSse2(const std::uint16_t* up, const std::uint16_t* cur, const std::uint16_t* down,
+                        std::uint32_t* out, unsigned int width) {
+  if (width < 2) {
+    energyRowScalar(up, cur, down, out, width);
+    return;
+  }
+  out[0] = energyAtScalar<std::uint16_t, std::uint32_t>(up, cur, down, 0, width);
+
+  const __m128i zero = _mm_setzero_si128();
+  unsigned int w = 1;
+  for (; w + 8 <= width - 1; w += 8) {
+    const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + w));
+    const __m128i l = absDiffEpu16(c, _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + w - 1)));
+    const __m128i r = absDiffEpu16(c, _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + w + 1)));
+    const __m128i t = absDiffEpu16(c, _mm_loadu_si128(reinterpret_cast<const __m128i*>(up + w)));
+    const __m128i b = absDiffEpu16(c, _mm_loadu_si128(reinterpret_cast<const __m128i*>(down + w)));
+
+    const __m128i lo = _mm_add_epi32(
+      _mm_add_epi32(_mm_unpacklo_epi16(l, zero), _mm_unpacklo_epi16(r, zero)),
+      _mm_add_epi32(_mm_unpacklo_epi16(t, zero), _mm_unpacklo_epi16(b, zero)));
+    const __m128i hi = _mm_add_epi32(
+      _mm_add_epi32(_mm_unpackhi_epi16(l, zero), _mm_unpackhi_epi16(r, zero)),
+      _mm_add_epi32(_mm_unpackhi_epi16(t, zero), _mm_unpackhi_epi16(b, zero)));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + w), lo);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + w + 4), hi);
+  }
+  for (; w < width; ++w) {
+    out[w] = energyAtScalar<std::uint16_t, std::uint32_t>(up, cur, down, w, width);
+  }
+}
+
+TARGET_AVX2 void energyRowAvx2(const std::uint16_t* up, const std::uint16_t* cur, const std::uint16_t* down,
+                        std::uint32_t* out, unsigned int width) {
+  if (width < 2) {
+    energyRowScalar(up, cur, down, out, width);
+    return;
+  }
+  out[0] = energyAtScalar<std::uint16_t, std::uint32_t>(up, cur, down, 0, width);
+
+  unsigned int w = 1;
+  for (; w + 16 <= width - 1; w += 16) {
+    const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur + w));
+    const __m256i l = absDiffEpu16(c, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur + w - 1)));
+    const __m256i r = absDiffEpu16(c, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur + w + 1)));
+    const __m256i t = absDiffEpu16(c, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(up + w)));
+    const __m256i b = absDiffEpu16(c, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(down + w)));
+
+    const __m256i lo = _mm256_add_epi32(
+      _mm256_add_epi32(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(l)),
+                       _mm256_cvtepu16_epi32(_mm256_castsi256_si128(r))),
+      _mm256_add_epi32(_mm256_cvtepu16_epi32(_mm256_castsi256_si128(t)),
+                       _mm256_cvtepu16_epi32(_mm256_castsi256_si128(b))));
+    const __m256i hi = _mm256_add_epi32(
+      _mm256_add_epi32(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(l, 1)),
+                       _mm256_cvtepu16_epi32(_mm256_extracti128_si256(r, 1))),
+      _mm256_add_epi32(_mm256_cvtepu16_epi32(_mm256_extracti128_si256(t, 1)),
+                       _mm256_cvtepu16_epi32(_mm256_extracti128_si256(b, 1))));
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + w), lo);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + w + 8), hi);
+  }
+  for (; w < width; ++w) {
+    out[w] = energyAtScalar<std::uint16_t, std::uint32_t>(up, cur, down, w, width);
+  }
+}
+
+TARGET_SSE2 void energyRowSse2(const std::int32_t* up, const std::int32_t* cur, const std::int32_t* down,
+                        std::int32_t* out, unsigned int width) {
+  if (width < 2) {
+    energyRowScalar(up, cur, down, out, width);
+    return;
+  }
+  out[0] = energyAtScalar<std::int32_t, std::int32_t>(up, cur, down, 0, width);
+
+  unsigned int w = 1;
+  for (; w + 4 <= width - 1; w += 4) {
+    const __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + w));
+    const __m128i l = absEpi32(_mm_sub_epi32(c, _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + w - 1))));
+    const __m128i r = absEpi32(_mm_sub_epi32(c, _mm_loadu_si128(reinterpret_cast<const __m128i*>(cur + w + 1))));
+    const __m128i t = absEpi32(_mm_sub_epi32(c, _mm_loadu_si128(reinterpret_cast<const __m128i*>(up + w))));
+    const __m128i b = absEpi32(_mm_sub_epi32(c, _mm_loadu_si128(reinterpret_cast<const __m128i*>(down + w))));
+
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(out + w),
+                     _mm_add_epi32(_mm_add_epi32(l, r), _mm_add_epi32(t, b)));
+  }
+  for (; w < width; ++w) {
+    out[w] = energyAtScalar<std::int32_t, std::int32_t>(up, cur, down, w, width);
+  }
+}
+
+TARGET_AVX2 void energyRowAvx2(const std::int32_t* up, const std::int32_t* cur, const std::int32_t* down,
+                        std::int32_t* out, unsigned int width) {
+  if (width < 2) {
+    energyRowScalar(up, cur, down, out, width);
+    return;
+  }
+  out[0] = energyAtScalar<std::int32_t, std::int32_t>(up, cur, down, 0, width);
+
+  unsigned int w = 1;
+  for (; w + 8 <= width - 1; w += 8) {
+    const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur + w));
+    const __m256i l = _mm256_abs_epi32(_mm256_sub_epi32(
+      c, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur + w - 1))));
+    const __m256i r = _mm256_abs_epi32(_mm256_sub_epi32(
+      c, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(cur + w + 1))));
+    const __m256i t = _mm256_abs_epi32(_mm256_sub_epi32(
+      c, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(up + w))));
+    const __m256i b = _mm256_abs_epi32(_mm256_sub_epi32(
+      c, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(down + w))));
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + w),
+                        _mm256_add_epi32(_mm256_add_epi32(l, r), _mm256_add_epi32(t, b)));
+  }
+  for (; w < width; ++w) {
+    out[w] = energyAtScalar<std::int32_t, std::int32_t>(up, cur, down, w, width);
+  }
+}
+
+// Cost kernels, cells at the edges of the grid are calculated by
+// the scalar kernel, as they lack one of their predecessors, as are
+// the cells past the last full vector
+
+#define COST_KERNEL(NAME, ATTR, E, C, LANES, LOAD_E, MIN, ADD)                      \
+  ATTR void NAME(const E* energy, const C* prev, C* out, unsigned int count,      \
+                 bool leftEdge, bool rightEdge) {                                 \
+    if (count == 0) {                                                             \
+      return;                                                                     \
+    }                                                                             \
+    unsigned int i = 0;                                                           \
+    if (leftEdge) {                                                               \
+      out[0] = costAtScalar(energy, prev, 0, count, leftEdge, rightEdge);         \
+      i = 1;                                                                      \
+    }                                                                             \
+    const unsigned int end = rightEdge ? count - 1 : count;                       \
+    for (; i + LANES <= end; i += LANES) {                                        \
+      const auto l = LOADU(prev + i - 1);                                         \
+      const auto c = LOADU(prev + i);                                             \
+      const auto r = LOADU(prev + i + 1);                                         \
+      STOREU(out + i, ADD(LOAD_E(energy + i), MIN(MIN(l, c), r)));                \
+    }                                                                             \
+    for (; i < count; ++i) {                                                      \
+      out[i] = costAtScalar(energy, prev, i, count, leftEdge, rightEdge);         \
+    }                                                                             \
+  }
+
+#define LOADU(p) _mm_loadu_si128(reinterpret_cast<const __m128i*>(p))
+#define STOREU(p, v) _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v)
+#define LOAD_U16_AS_32(p) _mm_unpacklo_epi16(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(p)), \
+                                             _mm_setzero_si128())
+
+COST_KERNEL(costRowSse2, TARGET_SSE2, std::uint16_t, std::uint32_t, 4, LOAD_U16_AS_32, minEpu32, _mm_add_epi32)
+COST_KERNEL(costRowSse2, TARGET_SSE2, std::uint32_t, std::uint32_t, 4, LOADU, minEpu32, _mm_add_epi32)
+COST_KERNEL(costRowSse2, TARGET_SSE2, std::int32_t, std::int32_t, 4, LOADU, minEpi32, _mm_add_epi32)
+
+#undef LOADU
+#undef STOREU
+#define LOADU(p) _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))
+#define STOREU(p, v) _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v)
+#define LOAD_U16_AS_32_256(p) _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)))
+
+COST_KERNEL(costRowAvx2, TARGET_AVX2, std::uint16_t, std::uint32_t, 8, LOAD_U16_AS_32_256, _mm256_min_epu32, _mm256_add_epi32)
+COST_KERNEL(costRowAvx2, TARGET_AVX2, std::uint32_t, std::uint32_t, 8, LOADU, _mm256_min_epu32, _mm256_add_epi32)
+COST_KERNEL(costRowAvx2, TARGET_AVX2, std::int32_t, std::int32_t, 8, LOADU, _mm256_min_epi32, _mm256_add_epi32)
+
+#undef LOADU
+#undef STOREU
+#undef LOAD_U16_AS_32
+#undef LOAD_U16_AS_32_256
+#undef COST_KERNEL
+#undef TARGET_SSE2
+#undef TARGET_AVX2
+
+#endif
+
+} // namespace
+
+// Dispatches a kernel call to the implementation matching the
+// active SIMD level
+#ifdef KERNELS_X86
+#define DISPATCH(SCALAR_FN, SSE2_FN, AVX2_FN, ...) \
+  switch (activeLevel) {                          \
+    case SimdLevel::AVX2:                         \
+      AVX2_FN(__VA_ARGS__);                       \
+      return;                                     \
+    case SimdLevel::SSE2:                         \
+      SSE2_FN(__VA_ARGS__);                       \
+      return;                                     \
+    case SimdLevel::SCALAR:                       \
+      break;                                      \
+  }                                               \
+  SCALAR_FN(__VA_ARGS__);
+#else
+#define DISPATCH(SCALAR_FN, SSE2_FN, AVX2_FN, ...) \
+  SCALAR_FN(__VA_ARGS__);
+#endif
+
+/** Gets the SIMD level kernels are currently dispatched to.
+
+    @returns the active SIMD level.
+ */
+SimdLevel getSimdLevel() {
+  return activeLevel;
+}
+
+/** Gets the widest SIMD level the running CPU supports.
+
+    @returns the supported SIMD level.
+ */
+SimdLevel getSupportedSimdLevel() {
+  return supportedLevel;
+}
+
+/** Sets the SIMD level kernels are dispatched to.
+
+    Primarily useful for validating and benchmarking the
+    vectorized kernels against the scalar kernels. Levels
+    the running CPU does not support are lowered to the
+    widest supported level. Must not be called while
+    kernels are running on other threads.
+
+    @param level
+    The requested SIMD level.
+ */
+void setSimdLevel(const SimdLevel& level) {
+  activeLevel = static_cast<int>(level) < static_cast<int>(supportedLevel) ? level : supportedLevel;
+}
+
+/** Calculates a row of an 8 bit pixel grid's energy grid.
+
+    @param up
+    The row above, or the row itself for the first row.
+
+    @param cur
+    The row to calculate energy values for.
+
+    @param down
+    The row below, or the row itself for the last row.
+
+    @param out
+    The energy row to store the results in.
+
+    @param width
+    The number of pixels in the row.
+ */
+void energyRow(const std::uint8_t* up, const std::uint8_t* cur, const std::uint8_t* down,
+               std::uint16_t* out, unsigned int width) {
+  DISPATCH(energyRowScalar, energyRowSse2, energyRowAvx2, up, cur, down, out, width)
+}
+
+/** Calculates a row of a 16 bit pixel grid's energy grid.
+
+    @param up
+    The row above, or the row itself for the first row.
+
+    @param cur
+    The row to calculate energy values for.
+
+    @param down
+    The row below, or the row itself for the last row.
+
+    @param out
+    The energy row to store the results in.
+
+    @param width
+    The number of pixels in the row.
+ */
+void energyRow(const std::uint16_t* up, const std::uint16_t* cur, const std::uint16_t* down,
+               std::uint32_t* out, unsigned int width) {
+  DISPATCH(energyRowScalar, energyRowSse2, energyRowAvx2, up, cur, down, out, width)
+}
+
+/** Calculates a row of a 32 bit pixel grid's energy grid.
+
+    @param up
+    The row above, or the row itself for the first row.
+
+    @param cur
+    The row to calculate energy values for.
+
+    @param down
+    The row below, or the row itself for the last row.
+
+    @param out
+    The energy row to store the results in.
+
+    @param width
+    The number of pixels in the row.
+ */
+void energyRow(const std::int32_t* up, const std::int32_t* cur, const std::int32_t* down,
+               std::int32_t* out, unsigned int width) {
+  DISPATCH(energyRowScalar, energyRowSse2, energyRowAvx2, up, cur, down, out, width)
+}
+
+/** Calculates a run of a cost grid row from 16 bit energy values.
+
+    @param energy
+    The energy values of the run.
+
+    @param prev
+    The previous row's cost values, aligned with the run.
+
+    @param out
+    The cost values to store the results in.
+
+    @param count
+    The number of cells in the run.
+
+    @param leftEdge
+    Whether the run starts at the edge of the grid,
+    otherwise prev[-1] must be valid.
+
+    @param rightEdge
+    Whether the run ends at the edge of the grid,
+    otherwise prev[count] must be valid.
+ */
+void costRow(const std::uint16_t* energy, const std::uint32_t* prev, std::uint32_t* out,
+             unsigned int count, bool leftEdge, bool rightEdge) {
+  DISPATCH(costRowScalar, costRowSse2, costRowAvx2, energy, prev, out, count, leftEdge, rightEdge)
+}
+
+/** Calculates a run of a cost grid row from 32 bit unsigned energy values.
+
+    @param energy
+    The energy values of the run.
+
+    @param prev
+    The previous row's cost values, aligned with the run.
+
+    @param out
+    The cost values to store the results in.
+
+    @param count
+    The number of cells in the run.
+
+    @param leftEdge
+    Whether the run starts at the edge of the grid,
+    otherwise prev[-1] must be valid.
+
+    @param rightEdge
+    Whether the run ends at the edge of the grid,
+    otherwise prev[count] must be valid.
+ */
+void costRow(const std::uint32_t* energy, const std::uint32_t* prev, std::uint32_t* out,
+             unsigned int count, bool leftEdge, bool rightEdge) {
+  DISPATCH(costRowScalar, costRowSse2, costRowAvx2, energy, prev, out, count, leftEdge, rightEdge)
+}
+
+/** Calculates a run of a cost grid row from 32 bit signed energy values.
+
+    @param energy
+    The energy values of the run.
+
+    @param prev
+    The previous row's cost values, aligned with the run.
+
+    @param out
+    The cost values to store the results in.
+
+    @param count
+    The number of cells in the run.
+
+    @param leftEdge
+    Whether the run starts at the edge of the grid,
+    otherwise prev[-1] must be valid.
+
+    @param rightEdge
+    Whether the run ends at the edge of the grid,
+    otherwise prev[count] must be valid.
+ */
+void costRow(const std::int32_t* energy, const std::int32_t* prev, std::int32_t* out,
+             unsigned int count, bool leftEdge, bool rightEdge) {
+  DISPATCH(costRowScalar, costRowSse2, costRowAvx2, energy, prev, out, count, leftEdge, rightEdge)
+}
@@ -0,0 +1,57 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef KERNELS_HPP
+#define KERNELS_HPP
+
+#include <cstdint>
+
+enum class SimdLevel {
+  SCALAR,
+  SSE2,
+  AVX2
+};
+
+SimdLevel getSimdLevel();
+SimdLevel getSupportedSimdLevel();
+void setSimdLevel(const SimdLevel&);
+
+void energyRow(const std::uint8_t*, const std::uint8_t*, const std::uint8_t*,
+               std::uint16_t*, unsigned int);
+void energyRow(const std::uint16_t*, const std::uint16_t*, const std::uint16_t*,
+               std::uint32_t*, unsigned int);
+void energyRow(const std::int32_t*, const std::int32_t*, const std::int32_t*,
+               std::int32_t*, unsigned int);
+
+void costRow(const std::uint16_t*, const std::uint32_t*, std::uint32_t*, unsigned int, bool, bool);
+void costRow(const std::uint32_t*, const std::uint32_t*, std::uint32_t*, unsigned int, bool, bool);
+void costRow(const std::int32_t*, const std::int32_t*, std::int32_t*, unsigned int, bool, bool);
+
+template <typename P, typename E>
+  void energyRow(const P*, const P*, const P*, E*, unsigned int);
+template <typename E, typename C>
+  void costRow(const E*, const C*, C*, unsigned int, bool, bool);
+
+template <typename P, typename E>
+  void energyRowScalar(const P*, const P*, const P*, E*, unsigned int);
+template <typename E, typename C>
+  void costRowScalar(const E*, const C*, C*, unsigned int, bool, bool);
+template <typename P, typename E>
+  E energyAtScalar(const P*, const P*, const P*, unsigned int, unsigned int);
+template <typename E, typename C>
+  C costAtScalar(const E*, const C*, unsigned int, unsigned int, bool, bool);
+
+#include "Kernels.ipp"
+#endif
@@ -0,0 +1,200 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cstdlib>
+
+/** Calculates a row of an energy grid.
+
+    Falls back to the scalar implementation for pixel
+    types without a vectorized kernel.
+
+    @param up
+    The row above, or the row itself for the first row.
+
+    @param cur
+    The row to calculate energy values for.
+
+    @param down
+    The row below, or the row itself for the last row.
+
+    @param out
+    The energy row to store the results in.
+
+    @param width
+    The number of pixels in the row.
+ */
+template <typename P, typename E>
+  void energyRow(const P* up, const P* cur, const P* down, E* out, unsigned int width) {
+    energyRowScalar(up, cur, down, out, width);
+  }
+
+/** Calculates a run of cells of a cost grid row.
+
+    Falls back to the scalar implementation for energy
+    and cost types without a vectorized kernel.
+
+    @param energy
+    The energy values of the run.
+
+    @param prev
+    The previous row's cost values, aligned with the run.
+
+    @param out
+    The cost values to store the results in.
+
+    @param count
+    The number of cells in the run.
+
+    @param leftEdge
+    Whether the run starts at the edge of the grid,
+    otherwise prev[-1] must be valid.
+
+    @param rightEdge
+    Whether the run ends at the edge of the grid,
+    otherwise prev[count] must be valid.
+ */
+template <typename E, typename C>
+  void costRow(const E* energy, const C* prev, C* out, unsigned int count, bool leftEdge, bool rightEdge) {
+    costRowScalar(energy, prev, out, count, leftEdge, rightEdge);
+  }
+
+/** Calculates a row of an energy grid, one pixel at a time.
+
+    Calculates the sum of the absolute value of the difference
+    in value between each pixel and its adjacent pixels. This
+    is the reference implementation every vectorized kernel
+    must match exactly.
+
+    @param up
+    The row above, or the row itself for the first row.
+
+    @param cur
+    The row to calculate energy values for.
+
+    @param down
+    The row below, or the row itself for the last row.
+
+    @param out
+    The energy row to store the results in.
+
+    @param width
+    The number of pixels in the row.
+ */
+template <typename P, typename E>
+  void energyRowScalar(const P* up, const P* cur, const P* down, E* out, unsigned int width) {
+    for (unsigned int w = 0; w < width; ++w) {
+      out[w] = energyAtScalar<P, E>(up, cur, down, w, width);
+    }
+  }
+
+/** Calculates a run of cells of a cost grid row, one cell at a time.
+
+    Every cell's cost is its energy value, plus the minimum
+    of the cost values of its (up to) three predecessors.
+    This is the reference implementation every vectorized
+    kernel must match exactly.
+
+    @param energy
+    The energy values of the run.
+
+    @param prev
+    The previous row's cost values, aligned with the run.
+
+    @param out
+    The cost values to store the results in.
+
+    @param count
+    The number of cells in the run.
+
+    @param leftEdge
+    Whether the run starts at the edge of the grid,
+    otherwise prev[-1] must be valid.
+
+    @param rightEdge
+    Whether the run ends at the edge of the grid,
+    otherwise prev[count] must be valid.
+ */
+template <typename E, typename C>
+  void costRowScalar(const E* energy, const C* prev, C* out, unsigned int count, bool leftEdge, bool rightEdge) {
+    for (unsigned int i = 0; i < count; ++i) {
+      out[i] = costAtScalar(energy, prev, i, count, leftEdge, rightEdge);
+    }
+  }
+
+/** Calculates the energy of a single pixel of a row.
+
+    @param up
+    The row above, or the row itself for the first row.
+
+    @param cur
+    The row containing the pixel.
+
+    @param down
+    The row below, or the row itself for the last row.
+
+    @param w
+    The position of the pixel in the row.
+
+    @param width
+    The number of pixels in the row.
+
+    @returns the energy of the pixel.
+ */
+template <typename P, typename E>
+  E energyAtScalar(const P* up, const P* cur, const P* down, unsigned int w, unsigned int width) {
+    // Gen diffs for each adjacent pixel
+    auto left   = w > 0         ? cur[w] - cur[w - 1] : 0;
+    auto right  = w < width - 1 ? cur[w] - cur[w + 1] : 0;
+    auto top    = cur[w] - up[w];
+    auto bottom = cur[w] - down[w];
+
+    return static_cast<E>(std::abs(left) + std::abs(right) + std::abs(top) + std::abs(bottom));
+  }
+
+/** Calculates the cost of a single cell of a run.
+
+    @param energy
+    The energy values of the run.
+
+    @param prev
+    The previous row's cost values, aligned with the run.
+
+    @param i
+    The position of the cell in the run.
+
+    @param count
+    The number of cells in the run.
+
+    @param leftEdge
+    Whether the run starts at the edge of the grid.
+
+    @param rightEdge
+    Whether the run ends at the edge of the grid.
+
+    @returns the cost of the cell.
+ */
+template <typename E, typename C>
+  C costAtScalar(const E* energy, const C* prev, unsigned int i, unsigned int count,
+                 bool leftEdge, bool rightEdge) {
+    C minVal = prev[i];
+    if (i > 0 || !leftEdge) {
+      minVal = std::min(minVal, prev[static_cast<int>(i) - 1]);
+    }
+    if (i + 1 < count || !rightEdge) {
+      minVal = std::min(minVal, prev[i + 1]);
+    }
+    return energy[i] + minVal;
+  }
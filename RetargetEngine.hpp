@@ -0,0 +1,67 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef RETARGETENGINE_HPP
+#define RETARGETENGINE_HPP
+
+#include <vector>
+
+#include "CarvingEngine.hpp"
+#include "SeamCarver.hpp"
+#include "Util/FlexGrid.hpp"
+#include "Util/ThreadPool.hpp"
+
+enum class SeamOrder {
+  VERTICAL_FIRST,
+  GREEDY,
+  OPTIMAL
+};
+
+template <typename P, typename E = typename EnergyOf<P>::type, typename C = typename CostOf<E>::type>
+class RetargetEngine {
+  SeamOrder order;
+  ThreadPool* pool;
+  CarvingEngine<P, E, C> vertical;
+  CarvingEngine<P, E, C> horizontal;
+  FlexGrid<P> result;
+  std::vector<CarvingMode> removals;
+  double removedEnergy;
+
+  FlexGrid<E> energy;
+  FlexGrid<C> cost;
+  std::vector<unsigned int> seam;
+public:
+  explicit RetargetEngine(const SeamOrder&);
+  RetargetEngine(const SeamOrder&, ThreadPool&);
+
+  void retarget(const FlexGrid<P>&, const unsigned int&, const unsigned int&);
+
+  FlexGrid<P> getGrid() const;
+  const std::vector<CarvingMode>& getRemovals() const;
+  double getRemovedEnergy() const;
+private:
+  void retargetVerticalFirst(const FlexGrid<P>&, const unsigned int&, const unsigned int&);
+  void retargetGreedy(const FlexGrid<P>&, const unsigned int&, const unsigned int&);
+  void retargetOptimal(const FlexGrid<P>&, const unsigned int&, const unsigned int&);
+
+  double removeCheapest(FlexGrid<P>&, const CarvingMode&);
+};
+
+template <typename T>
+  FlexGrid<T> retarget(const FlexGrid<T>&, const unsigned int&, const unsigned int&, const SeamOrder&,
+                       ThreadPool&);
+
+#include "RetargetEngine.ipp"
+#endif
@@ -0,0 +1,373 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "RetargetEngine.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+/** Construct a new RetargetEngine object.
+
+    @param order
+    How the order of vertical and horizontal seam
+    removals is picked.
+ */
+template <typename P, typename E, typename C>
+  RetargetEngine<P, E, C>::RetargetEngine(const SeamOrder& order) :
+    order(order),
+    pool(nullptr),
+    result(0, 0),
+    removedEnergy(0),
+    energy(0, 0),
+    cost(0, 0) { }
+
+/** Construct a new RetargetEngine object.
+
+    Constructs a new RetargetEngine object, which splits
+    its energy and cost grid calculations across the
+    provided thread pool.
+
+    @param order
+    How the order of vertical and horizontal seam
+    removals is picked.
+
+    @param pool
+    The thread pool to split calculations across, which
+    must outlive the engine.
+ */
+template <typename P, typename E, typename C>
+  RetargetEngine<P, E, C>::RetargetEngine(const SeamOrder& order, ThreadPool& pool) :
+    order(order),
+    pool(&pool),
+    vertical(pool),
+    horizontal(pool),
+    result(0, 0),
+    removedEnergy(0),
+    energy(0, 0),
+    cost(0, 0) { }
+
+/** Retargets a pixel grid to a smaller size.
+
+    Removes vertical and horizontal seams from a copy of
+    the grid until it reaches the target size, in an order
+    picked by the engine's seam order:
+
+    VERTICAL_FIRST removes every vertical seam, then every
+    horizontal seam.
+
+    GREEDY removes whichever of the cheapest vertical and
+    cheapest horizontal seam costs less, ties favoring the
+    vertical seam. An engine per carving mode keeps its cost
+    grid alive, each removing the other's seams as they
+    are removed.
+
+    OPTIMAL picks the order using Avidan and Shamir's transport
+    map, costing two full seam searches per combination of
+    vertical and horizontal seam counts. As the map keeps a
+    single pixel grid per entry, the order is approximate, and
+    may remove more energy than the other orders. It suits
+    small images and reductions only.
+
+    @param grid
+    The pixel grid to copy and remove seams from.
+
+    @param width
+    The width to reduce the grid to.
+
+    @param height
+    The height to reduce the grid to.
+ */
+template <typename P, typename E, typename C>
+  void RetargetEngine<P, E, C>::retarget(const FlexGrid<P>& grid, const unsigned int& width,
+                                         const unsigned int& height) {
+    if (width > grid.getWidth() || height > grid.getHeight()) {
+      throw std::runtime_error("Target size exceeds the grid!");
+    }
+    const unsigned int cols = grid.getWidth() - width;
+    const unsigned int rows = grid.getHeight() - height;
+
+    removals.clear();
+    removedEnergy = 0;
+    switch (order) {
+      case SeamOrder::VERTICAL_FIRST:
+        retargetVerticalFirst(grid, cols, rows);
+        return;
+      case SeamOrder::GREEDY:
+        retargetGreedy(grid, cols, rows);
+        return;
+      case SeamOrder::OPTIMAL:
+        retargetOptimal(grid, cols, rows);
+        return;
+    }
+    throw std::runtime_error("Invalid Seam Order!");
+  }
+
+/** Retrieves the retargeted pixel grid.
+
+    @returns the pixel grid, with all removed seams removed.
+ */
+template <typename P, typename E, typename C>
+  FlexGrid<P> RetargetEngine<P, E, C>::getGrid() const {
+    return result;
+  }
+
+/** Retrieves the order seams were removed in.
+
+    @returns the carving mode of every removed seam,
+    in order of removal.
+ */
+template <typename P, typename E, typename C>
+  const std::vector<CarvingMode>& RetargetEngine<P, E, C>::getRemovals() const {
+    return removals;
+  }
+
+/** Gets the total energy of every removed pixel.
+
+    @returns the total removed energy, as measured
+    when each seam was removed.
+ */
+template <typename P, typename E, typename C>
+  double RetargetEngine<P, E, C>::getRemovedEnergy() const {
+    return removedEnergy;
+  }
+
+/** Removes every vertical seam, then every horizontal seam.
+
+    @param grid
+    The pixel grid to copy and remove seams from.
+
+    @param cols
+    The number of vertical seams to remove.
+
+    @param rows
+    The number of horizontal seams to remove.
+ */
+template <typename P, typename E, typename C>
+  void RetargetEngine<P, E, C>::retargetVerticalFirst(const FlexGrid<P>& grid, const unsigned int& cols,
+                                                      const unsigned int& rows) {
+    vertical.reset(grid, CarvingMode::VERTICAL);
+    vertical.removeSeams(cols);
+    removedEnergy += vertical.getRemovedEnergy();
+
+    vertical.setMode(CarvingMode::HORIZONTAL);
+    vertical.removeSeams(rows);
+    removedEnergy += vertical.getRemovedEnergy();
+
+    removals.assign(cols, CarvingMode::VERTICAL);
+    removals.insert(removals.end(), rows, CarvingMode::HORIZONTAL);
+    result = vertical.getGrid();
+  }
+
+/** Removes the cheaper of the next vertical and horizontal seams, one at a time.
+
+    Once either direction has no seams left to remove, its
+    engine is no longer kept in step.
+
+    @param grid
+    The pixel grid to copy and remove seams from.
+
+    @param cols
+    The number of vertical seams to remove.
+
+    @param rows
+    The number of horizontal seams to remove.
+ */
+template <typename P, typename E, typename C>
+  void RetargetEngine<P, E, C>::retargetGreedy(const FlexGrid<P>& grid, const unsigned int& cols,
+                                               const unsigned int& rows) {
+    vertical.reset(grid, CarvingMode::VERTICAL);
+    horizontal.reset(grid, CarvingMode::HORIZONTAL);
+
+    unsigned int colsLeft = cols;
+    unsigned int rowsLeft = rows;
+    while (colsLeft > 0 || rowsLeft > 0) {
+      const bool pickVertical = rowsLeft == 0 ||
+        (colsLeft > 0 && vertical.getCheapestCost() <= horizontal.getCheapestCost());
+
+      if (pickVertical) {
+        vertical.removeSeam();
+        --colsLeft;
+        if (rowsLeft > 0) {
+          horizontal.removeCrossSeam(vertical.getSeam());
+        }
+        removals.push_back(CarvingMode::VERTICAL);
+      } else {
+        horizontal.removeSeam();
+        --rowsLeft;
+        if (colsLeft > 0) {
+          vertical.removeCrossSeam(horizontal.getSeam());
+        }
+        removals.push_back(CarvingMode::HORIZONTAL);
+      }
+    }
+
+    removedEnergy = vertical.getRemovedEnergy() + horizontal.getRemovedEnergy();
+
+    // The engine which removed the last seam is always in step
+    if (!removals.empty() && removals.back() == CarvingMode::HORIZONTAL) {
+      result = horizontal.getGrid();
+    } else {
+      result = vertical.getGrid();
+    }
+  }
+
+/** Removes seams in the order picked by Avidan and Shamir's transport map.
+
+    Fills the transport map one row of horizontal seam counts
+    at a time, keeping the pixel grid reached at every entry
+    of the current and previous rows. Each entry is reached
+    either by removing a horizontal seam from the entry above,
+    or a vertical seam from the entry to its left, whichever
+    removes less energy in total, ties favoring the vertical
+    seam. The order is then recovered by walking back through
+    the choices made. Only the cheaper way of reaching each
+    entry is kept, so the order is an approximation, not the
+    order removing the least total energy.
+
+    @param grid
+    The pixel grid to copy and remove seams from.
+
+    @param cols
+    The number of vertical seams to remove.
+
+    @param rows
+    The number of horizontal seams to remove.
+ */
+template <typename P, typename E, typename C>
+  void RetargetEngine<P, E, C>::retargetOptimal(const FlexGrid<P>& grid, const unsigned int& cols,
+                                                const unsigned int& rows) {
+    std::vector<FlexGrid<P>> prev(cols + 1, FlexGrid<P>(0, 0));
+    std::vector<FlexGrid<P>> cur(cols + 1, FlexGrid<P>(0, 0));
+    std::vector<double> prevTotal(cols + 1);
+    std::vector<double> curTotal(cols + 1);
+    FlexGrid<P> spare(0, 0);
+
+    // Whether each entry was reached by removing a vertical seam
+    FlexGrid<unsigned char> choices(cols + 1, rows + 1);
+
+    cur[0].assign(grid);
+    curTotal[0] = 0;
+    for (unsigned int c = 1; c <= cols; ++c) {
+      cur[c].assign(cur[c - 1]);
+      curTotal[c] = curTotal[c - 1] + removeCheapest(cur[c], CarvingMode::VERTICAL);
+      choices(c, 0) = 1;
+    }
+
+    for (unsigned int r = 1; r <= rows; ++r) {
+      std::swap(prev, cur);
+      std::swap(prevTotal, curTotal);
+      for (unsigned int c = 0; c <= cols; ++c) {
+        cur[c].assign(prev[c]);
+        curTotal[c] = prevTotal[c] + removeCheapest(cur[c], CarvingMode::HORIZONTAL);
+        choices(c, r) = 0;
+
+        if (c > 0) {
+          spare.assign(cur[c - 1]);
+          const double across = curTotal[c - 1] + removeCheapest(spare, CarvingMode::VERTICAL);
+          if (across <= curTotal[c]) {
+            std::swap(cur[c], spare);
+            curTotal[c] = across;
+            choices(c, r) = 1;
+          }
+        }
+      }
+    }
+
+    // Walk back from the target to the original size
+    unsigned int c = cols;
+    unsigned int r = rows;
+    while (c > 0 || r > 0) {
+      if (choices(c, r)) {
+        removals.push_back(CarvingMode::VERTICAL);
+        --c;
+      } else {
+        removals.push_back(CarvingMode::HORIZONTAL);
+        --r;
+      }
+    }
+    std::reverse(removals.begin(), removals.end());
+
+    removedEnergy = curTotal[cols];
+    result = std::move(cur[cols]);
+  }
+
+/** Removes the seam of least significance from a pixel grid.
+
+    Performs a full seam search, using the same tie
+    breaking as every other seam search.
+
+    @param grid
+    The pixel grid to remove from.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+
+    @returns the total energy of the removed seam.
+ */
+template <typename P, typename E, typename C>
+  double RetargetEngine<P, E, C>::removeCheapest(FlexGrid<P>& grid, const CarvingMode& mode) {
+    if (pool) {
+      calcEnergyInto(grid, energy, *pool);
+      calcCostInto(energy, cost, mode, *pool);
+    } else {
+      calcEnergyInto(grid, energy);
+      calcCostInto(energy, cost, mode);
+    }
+    traceSeam(cost, mode, seam);
+
+    // The cost of the seam's last pixel is its total energy
+    const double total = mode == CarvingMode::VERTICAL ?
+      cost(seam.back(), cost.getHeight() - 1) : cost(cost.getWidth() - 1, seam.back());
+    compactSeam(grid, seam, mode);
+    return total;
+  }
+
+/** Retargets a pixel grid, picking the narrowest safe cost type.
+
+    @param grid
+    The pixel grid to copy and remove seams from.
+
+    @param width
+    The width to reduce the grid to.
+
+    @param height
+    The height to reduce the grid to.
+
+    @param order
+    How the order of vertical and horizontal seam
+    removals is picked.
+
+    @param pool
+    The thread pool to split calculations across.
+
+    @returns the retargeted pixel grid.
+ */
+template <typename T>
+  FlexGrid<T> retarget(const FlexGrid<T>& grid, const unsigned int& width, const unsigned int& height,
+                       const SeamOrder& order, ThreadPool& pool) {
+    typedef typename EnergyOf<T>::type E;
+    typedef typename CostOf<E>::type C;
+
+    // Seams run along both deminsions
+    if (needsWideCost<T>(std::max(grid.getWidth(), grid.getHeight()))) {
+      RetargetEngine<T, E, typename WideCostOf<C>::type> engine(order, pool);
+      engine.retarget(grid, width, height);
+      return engine.getGrid();
+    }
+    RetargetEngine<T, E, C> engine(order, pool);
+    engine.retarget(grid, width, height);
+    return engine.getGrid();
+  }
@@ -16,24 +16,111 @@
 #ifndef SEAMCARVER_HPP
 #define SEAMCARVER_HPP
 
+#include <cstdint>
+#include <vector>
+
+#include "CarvingTypes.hpp"
 #include "Util/FlexGrid.hpp"
+#include "Util/ThreadPool.hpp"
 
 enum class CarvingMode {
   HORIZONTAL,
   VERTICAL
 };
 
+enum class SearchMode {
+  FULL,
+  PYRAMID
+};
+
+enum class EnergyKind {
+  GRADIENT,
+  SOBEL,
+  FORWARD
+};
+
+enum class MaskCell : std::uint8_t {
+  NONE,
+  PROTECT,
+  REMOVE
+};
+
+template <typename P, typename E = typename EnergyOf<P>::type, typename C = typename CostOf<E>::type>
+class CarvingEngine;
+
+template <typename P>
+  bool needsWideCost(const unsigned int&);
+
 template <typename T>
   FlexGrid<T> seamCarve(const FlexGrid<T>&, const CarvingMode&, const unsigned int&);
+template <typename T>
+  FlexGrid<T> seamCarve(const FlexGrid<T>&, const CarvingMode&, const unsigned int&, ThreadPool&);
+template <typename T>
+  FlexGrid<T> seamCarve(const FlexGrid<T>&, const CarvingMode&, const unsigned int&, ThreadPool&,
+                        const unsigned int&);
+template <typename T>
+  FlexGrid<T> seamCarve(const FlexGrid<T>&, const CarvingMode&, const unsigned int&, ThreadPool&,
+                        const unsigned int&, const SearchMode&, const unsigned int&);
 
 template <typename T>
-  FlexGrid<T> calcEnergy(const FlexGrid<T>&);
+  FlexGrid<T> seamCarve(const FlexGrid<T>&, const CarvingMode&, const unsigned int&, ThreadPool&,
+                        const EnergyKind&);
+template <typename T>
+  FlexGrid<T> seamCarve(const FlexGrid<T>&, const CarvingMode&, const unsigned int&, ThreadPool&,
+                        const unsigned int&, FlexGrid<MaskCell>&);
 
 template <typename T>
-  FlexGrid<T> calcCost(const FlexGrid<T>&, const CarvingMode&);
+  FlexGrid<T> seamInsert(const FlexGrid<T>&, const CarvingMode&, const unsigned int&);
+template <typename T>
+  FlexGrid<T> seamInsert(const FlexGrid<T>&, const CarvingMode&, const unsigned int&, ThreadPool&);
+template <typename T>
+  FlexGrid<T> seamInsert(const FlexGrid<T>&, const CarvingMode&, const unsigned int&, ThreadPool&,
+                         const unsigned int&);
+template <typename T>
+  void duplicateSeams(const FlexGrid<T>&, const FlexGrid<unsigned int>&, const unsigned int&,
+                      const CarvingMode&, FlexGrid<T>&);
+
+template <typename P, typename E = typename EnergyOf<P>::type>
+  FlexGrid<E> calcEnergy(const FlexGrid<P>&);
+template <typename P, typename E = typename EnergyOf<P>::type>
+  FlexGrid<E> calcEnergy(const FlexGrid<P>&, ThreadPool&);
+template <typename P, typename E>
+  void calcEnergyInto(const FlexGrid<P>&, FlexGrid<E>&);
+template <typename P, typename E>
+  void calcEnergyInto(const FlexGrid<P>&, FlexGrid<E>&, ThreadPool&);
+
+template <typename P, typename E = typename EnergyOf<P>::type>
+  E calcEnergyAt(const FlexGrid<P>&, const unsigned int&, const unsigned int&);
+
+template <typename E, typename C = typename CostOf<E>::type>
+  FlexGrid<C> calcCostH(const FlexGrid<E>&);
+template <typename E, typename C = typename CostOf<E>::type>
+  FlexGrid<C> calcCostV(const FlexGrid<E>&);
+template <typename E, typename C = typename CostOf<E>::type>
+  FlexGrid<C> calcCost(const FlexGrid<E>&, const CarvingMode&);
+template <typename E, typename C = typename CostOf<E>::type>
+  FlexGrid<C> calcCost(const FlexGrid<E>&, const CarvingMode&, ThreadPool&);
+template <typename E, typename C>
+  void calcCostInto(const FlexGrid<E>&, FlexGrid<C>&, const CarvingMode&);
+template <typename E, typename C>
+  void calcCostInto(const FlexGrid<E>&, FlexGrid<C>&, const CarvingMode&, ThreadPool&);
+
+template <typename F, typename P, typename C>
+  void calcCostFused(const FlexGrid<P>&, FlexGrid<C>&);
+template <typename F, typename P, typename C>
+  void calcCostFused(const FlexGrid<P>&, FlexGrid<C>&, ThreadPool&);
 
 template <typename T>
-  void traceBackRem(FlexGrid<T>&, const FlexGrid<T>&, const CarvingMode&);
+  void traceSeam(const FlexGrid<T>&, const CarvingMode&, std::vector<unsigned int>&);
+template <typename T>
+  void compactSeam(FlexGrid<T>&, const std::vector<unsigned int>&, const CarvingMode&);
+
+template <typename T, typename C>
+  void traceBackRem(FlexGrid<T>&, const FlexGrid<C>&, const CarvingMode&);
+template <typename T, typename C>
+  void traceBackRemH(FlexGrid<T>&, const FlexGrid<C>&);
+template <typename T, typename C>
+  void traceBackRemV(FlexGrid<T>&, const FlexGrid<C>&);
 
 
 #include "SeamCarver.ipp"
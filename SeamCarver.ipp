@@ -16,10 +16,132 @@
 #include "SeamCarver.hpp"
 
 #include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
 #include <stdexcept>
+#include <type_traits>
+#include <vector>
 
+#include "CarvingEngine.hpp"
+#include "Energy.hpp"
+#include "FusedEngine.hpp"
+#include "Kernels.hpp"
 #include "Util/Optional.hpp"
 
+/** Checks whether seams may overflow the usual cost type.
+
+    Every pixel contributes at most four times the largest
+    pixel value to a seam's cost, so seams longer than the
+    usual cost type can accumulate require the wide cost type.
+
+    @param length
+    The number of pixels in every seam, the height of the grid
+    for vertical seams, or its width for horizontal seams.
+
+    @returns true if the wide cost type is required.
+ */
+template <typename P>
+  bool needsWideCost(const unsigned int& length) {
+    typedef typename CostOf<typename EnergyOf<P>::type>::type C;
+    if (!std::is_unsigned<P>::value || !std::is_unsigned<C>::value) {
+      return false;
+    }
+    const double maxCost = 4.0 * std::numeric_limits<P>::max() * length;
+    return maxCost > static_cast<double>(std::numeric_limits<C>::max());
+  }
+
+/** Runs the seam carving algorithm with the provided cost type.
+
+    @param grid
+    The pixel grid to copy and remove seams from.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+
+    @param amt
+    The amt of seams to remove.
+
+    @param pool
+    The thread pool to split calculations across,
+    or nullptr to calculate on this thread.
+
+    @param batch
+    The maximum number of seams to remove per cost grid.
+
+    @param search
+    How seams are searched for.
+
+    @param levels
+    The number of coarser levels of a pyramid search.
+
+    @returns the altered pixel grid, with all
+    requested seams removed.
+ */
+template <typename C, typename T>
+  FlexGrid<T> seamCarveWith(const FlexGrid<T>& grid, const CarvingMode& mode, const unsigned int& amt,
+                            ThreadPool* pool, const unsigned int& batch, const SearchMode& search,
+                            const unsigned int& levels) {
+    typedef typename EnergyOf<T>::type E;
+
+    // Hand a copy of the grid to a carving engine, which keeps
+    // its energy and cost grids alive between seams, only
+    // refreshing the cells each removed seam has affected
+    if (pool) {
+      CarvingEngine<T, E, C> engine(*pool);
+      engine.setSearch(search, levels);
+      engine.reset(grid, mode);
+      engine.removeSeams(amt, batch);
+      return engine.getGrid();
+    }
+    CarvingEngine<T, E, C> engine;
+    engine.setSearch(search, levels);
+    engine.reset(grid, mode);
+    engine.removeSeams(amt, batch);
+    return engine.getGrid();
+  }
+
+/** Runs the seam carving algorithm, picking the narrowest safe cost type.
+
+    @param grid
+    The pixel grid to copy and remove seams from.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+
+    @param amt
+    The amt of seams to remove.
+
+    @param pool
+    The thread pool to split calculations across,
+    or nullptr to calculate on this thread.
+
+    @param batch
+    The maximum number of seams to remove per cost grid.
+
+    @param search
+    How seams are searched for.
+
+    @param levels
+    The number of coarser levels of a pyramid search.
+
+    @returns the altered pixel grid, with all
+    requested seams removed.
+ */
+template <typename T>
+  FlexGrid<T> seamCarveAny(const FlexGrid<T>& grid, const CarvingMode& mode, const unsigned int& amt,
+                           ThreadPool* pool, const unsigned int& batch, const SearchMode& search,
+                           const unsigned int& levels) {
+    typedef typename CostOf<typename EnergyOf<T>::type>::type C;
+
+    const unsigned int length = mode == CarvingMode::VERTICAL ? grid.getHeight() : grid.getWidth();
+    if (needsWideCost<T>(length)) {
+      return seamCarveWith<typename WideCostOf<C>::type>(grid, mode, amt, pool, batch, search, levels);
+    }
+    return seamCarveWith<C>(grid, mode, amt, pool, batch, search, levels);
+  }
+
 /** Runs the seam carving algorithm.
 
     Given a grid of pixel values, the carving mode,
@@ -27,6 +149,13 @@
     creates a copy of the grid, and then processes
     said copy, removing the requested number of seams.
 
+    Only the first seam requires a full energy and
+    cost calculation, every following seam only
+    recalculates the cells affected by its predecessor.
+
+    Energy and cost values are kept in the narrowest types
+    able to hold them for the pixel type, see CarvingTypes.hpp.
+
     @param grid
     The pixel grid to copy and remove seams from.
 
@@ -41,18 +170,490 @@
  */
 template <typename T>
   FlexGrid<T> seamCarve(const FlexGrid<T>& grid, const CarvingMode& mode, const unsigned int& amt) {
-    // Create a copy of the grid, so that we do not modify the original
-    FlexGrid<T> newGrid = grid;
-    // Repeat the seam carving process amt times
-    for (unsigned int i = 0; i < amt; ++i) {
-      // Begin by caclulating an energy grid
-      FlexGrid<T> energyGrid = calcEnergy(newGrid);
-      // Use the energy grid to obtain a cost grid for the given mode
-      FlexGrid<T> costGrid = calcCost(energyGrid, mode);
-      // Finally trace back removing the least significant seam
-      traceBackRem(newGrid, costGrid, mode);
+    return seamCarveAny(grid, mode, amt, nullptr, 1, SearchMode::FULL, 0);
+  }
+
+/** Runs the seam carving algorithm across multiple threads.
+
+    Behaves identically to the single threaded seamCarve,
+    producing the same result, but splits energy and cost
+    grid calculations across the provided thread pool.
+
+    @param grid
+    The pixel grid to copy and remove seams from.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+
+    @param amt
+    The amt of seams to remove.
+
+    @param pool
+    The thread pool to split calculations across.
+
+    @returns the altered pixel grid, with all
+    requested seams removed.
+ */
+template <typename T>
+  FlexGrid<T> seamCarve(const FlexGrid<T>& grid, const CarvingMode& mode, const unsigned int& amt,
+                        ThreadPool& pool) {
+    return seamCarveAny(grid, mode, amt, &pool, 1, SearchMode::FULL, 0);
+  }
+
+/** Runs the seam carving algorithm, removing several seams per pass.
+
+    Rather than calculating a new cost grid for every seam,
+    up to batch non-crossing seams are removed per cost grid.
+    Larger batches trade carving quality for throughput,
+    a batch size of 1 is equivalent to seamCarve without
+    a batch size.
+
+    @param grid
+    The pixel grid to copy and remove seams from.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+
+    @param amt
+    The amt of seams to remove.
+
+    @param pool
+    The thread pool to split calculations across.
+
+    @param batch
+    The maximum number of seams to remove per cost grid.
+
+    @returns the altered pixel grid, with all
+    requested seams removed.
+ */
+template <typename T>
+  FlexGrid<T> seamCarve(const FlexGrid<T>& grid, const CarvingMode& mode, const unsigned int& amt,
+                        ThreadPool& pool, const unsigned int& batch) {
+    return seamCarveAny(grid, mode, amt, &pool, batch, SearchMode::FULL, 0);
+  }
+
+/** Runs the seam carving algorithm, searching for seams coarse to fine.
+
+    A pyramid search finds each seam on a downsampled copy of the
+    grid, then refines it at full resolution only within a narrow
+    band around the upscaled path. Every level of the pyramid halves
+    both deminsions. Seams are no longer guaranteed to be the
+    cheapest, trading carving quality for throughput. Batches do
+    not apply to pyramid searches.
+
+    @param grid
+    The pixel grid to copy and remove seams from.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+
+    @param amt
+    The amt of seams to remove.
+
+    @param pool
+    The thread pool to split calculations across.
+
+    @param batch
+    The maximum number of seams to remove per cost grid.
+
+    @param search
+    How seams are searched for.
+
+    @param levels
+    The number of coarser levels of a pyramid search.
+
+    @returns the altered pixel grid, with all
+    requested seams removed.
+ */
+template <typename T>
+  FlexGrid<T> seamCarve(const FlexGrid<T>& grid, const CarvingMode& mode, const unsigned int& amt,
+                        ThreadPool& pool, const unsigned int& batch, const SearchMode& search,
+                        const unsigned int& levels) {
+    return seamCarveAny(grid, mode, amt, &pool, batch, search, levels);
+  }
+
+/** Runs the seam carving algorithm with the provided energy function.
+
+    Picks the narrowest safe cost type, every energy function
+    staying within the range of the gradient energy.
+
+    @param grid
+    The pixel grid to copy and remove seams from.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+
+    @param amt
+    The amt of seams to remove.
+
+    @param pool
+    The thread pool to split calculations across.
+
+    @returns the altered pixel grid, with all
+    requested seams removed.
+ */
+template <typename F, typename T>
+  FlexGrid<T> seamCarveFused(const FlexGrid<T>& grid, const CarvingMode& mode, const unsigned int& amt,
+                             ThreadPool& pool) {
+    typedef typename EnergyOf<T>::type E;
+    typedef typename CostOf<E>::type C;
+
+    const unsigned int length = mode == CarvingMode::VERTICAL ? grid.getHeight() : grid.getWidth();
+    if (needsWideCost<T>(length)) {
+      FusedEngine<F, T, E, typename WideCostOf<C>::type> engine(pool);
+      engine.reset(grid, mode);
+      engine.removeSeams(amt);
+      return engine.getGrid();
+    }
+    FusedEngine<F, T, E, C> engine(pool);
+    engine.reset(grid, mode);
+    engine.removeSeams(amt);
+    return engine.getGrid();
+  }
+
+/** Runs the seam carving algorithm, picking the energy function.
+
+    The gradient energy carves exactly as seamCarve does. Sobel
+    and forward energies are carved by a FusedEngine, which
+    calculates each cell's energy while calculating its cost,
+    never holding an energy grid.
+
+    @param grid
+    The pixel grid to copy and remove seams from.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+
+    @param amt
+    The amt of seams to remove.
+
+    @param pool
+    The thread pool to split calculations across.
+
+    @param energy
+    The energy function to carve with.
+
+    @returns the altered pixel grid, with all
+    requested seams removed.
+ */
+template <typename T>
+  FlexGrid<T> seamCarve(const FlexGrid<T>& grid, const CarvingMode& mode, const unsigned int& amt,
+                        ThreadPool& pool, const EnergyKind& energy) {
+    switch (energy) {
+      case EnergyKind::GRADIENT:
+        return seamCarveAny(grid, mode, amt, &pool, 1, SearchMode::FULL, 0);
+      case EnergyKind::SOBEL:
+        return seamCarveFused<SobelEnergy>(grid, mode, amt, pool);
+      case EnergyKind::FORWARD:
+        return seamCarveFused<ForwardEnergy>(grid, mode, amt, pool);
+    }
+    throw std::runtime_error("Invalid Energy Function!");
+  }
+
+/** Runs the seam carving algorithm, honouring a mask.
+
+    Seams never cross protected pixels while any other seam
+    remains, and always cross as many pixels marked for removal
+    as they can. When the mask marks pixels for removal, seams
+    are only removed until none of them remain, so amt becomes
+    the most seams to remove. Masked costs are accumulated in
+    a signed 64 bit type, able to hold the mask's biases.
+
+    @param grid
+    The pixel grid to copy and remove seams from.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+
+    @param amt
+    The amt of seams to remove, at most.
+
+    @param pool
+    The thread pool to split energy calculations across.
+
+    @param batch
+    The maximum number of seams to remove per cost grid.
+
+    @param mask
+    The mask, holding one cell per pixel, which is carved
+    along with the pixel grid.
+
+    @returns the altered pixel grid, with the
+    requested seams removed.
+ */
+template <typename T>
+  FlexGrid<T> seamCarve(const FlexGrid<T>& grid, const CarvingMode& mode, const unsigned int& amt,
+                        ThreadPool& pool, const unsigned int& batch, FlexGrid<MaskCell>& mask) {
+    typedef typename EnergyOf<T>::type E;
+
+    CarvingEngine<T, E, std::int64_t> engine(pool);
+    engine.reset(grid, mode);
+    engine.setMask(mask);
+    if (engine.getRemovalsLeft() > 0) {
+      engine.removeMarked(amt, batch);
+    } else {
+      engine.removeSeams(amt, batch);
+    }
+    mask = engine.getMask();
+    return engine.getGrid();
+  }
+
+/** Runs seam insertion simulations using the provided engine.
+
+    Removes up to the width (or height) of the grid in seams
+    at a time, recording the order pixels were removed in,
+    then duplicates every removed pixel in a single pass.
+
+    @param engine
+    The carving engine to simulate removals with.
+
+    @param grid
+    The pixel grid to copy and insert seams into.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+
+    @param amt
+    The amt of seams to insert.
+
+    @param batch
+    The maximum number of seams to remove per cost grid
+    while simulating.
+
+    @returns the enlarged pixel grid.
+ */
+template <typename Engine, typename T>
+  FlexGrid<T> seamInsertUsing(Engine& engine, const FlexGrid<T>& grid, const CarvingMode& mode,
+                              const unsigned int& amt, const unsigned int& batch) {
+    FlexGrid<T> source = grid;
+    FlexGrid<T> result(0, 0);
+    unsigned int left = amt;
+    while (left > 0) {
+      // A single simulation can at most remove every pixel
+      // of a row (or column) once
+      const unsigned int length = mode == CarvingMode::VERTICAL ? source.getWidth() : source.getHeight();
+      if (length < 1) {
+        throw std::runtime_error("No seams to duplicate!");
+      }
+      const unsigned int step = std::min(left, length);
+
+      engine.reset(source, mode);
+      engine.trackRemovals();
+      engine.removeSeams(step, batch);
+      duplicateSeams(source, engine.getRemovalOrder(), step, mode, result);
+
+      std::swap(source, result);
+      left -= step;
+    }
+    return source;
+  }
+
+/** Runs the seam insertion algorithm with the provided cost type.
+
+    @param grid
+    The pixel grid to copy and insert seams into.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+
+    @param amt
+    The amt of seams to insert.
+
+    @param pool
+    The thread pool to split calculations across,
+    or nullptr to calculate on this thread.
+
+    @param batch
+    The maximum number of seams to remove per cost grid
+    while simulating.
+
+    @returns the enlarged pixel grid.
+ */
+template <typename C, typename T>
+  FlexGrid<T> seamInsertWith(const FlexGrid<T>& grid, const CarvingMode& mode, const unsigned int& amt,
+                             ThreadPool* pool, const unsigned int& batch) {
+    typedef typename EnergyOf<T>::type E;
+
+    if (pool) {
+      CarvingEngine<T, E, C> engine(*pool);
+      return seamInsertUsing(engine, grid, mode, amt, batch);
+    }
+    CarvingEngine<T, E, C> engine;
+    return seamInsertUsing(engine, grid, mode, amt, batch);
+  }
+
+/** Runs a seam insertion simulation, picking the narrowest safe cost type.
+
+    @param grid
+    The pixel grid to copy and insert seams into.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+
+    @param amt
+    The amt of seams to insert.
+
+    @param pool
+    The thread pool to split calculations across,
+    or nullptr to calculate on this thread.
+
+    @param batch
+    The maximum number of seams to remove per cost grid
+    while simulating.
+
+    @returns the enlarged pixel grid.
+ */
+template <typename T>
+  FlexGrid<T> seamInsertAny(const FlexGrid<T>& grid, const CarvingMode& mode, const unsigned int& amt,
+                            ThreadPool* pool, const unsigned int& batch) {
+    typedef typename CostOf<typename EnergyOf<T>::type>::type C;
+
+    // Inserting seams never lengthens them
+    const unsigned int length = mode == CarvingMode::VERTICAL ? grid.getHeight() : grid.getWidth();
+    if (needsWideCost<T>(length)) {
+      return seamInsertWith<typename WideCostOf<C>::type>(grid, mode, amt, pool, batch);
+    }
+    return seamInsertWith<C>(grid, mode, amt, pool, batch);
+  }
+
+/** Runs the seam insertion algorithm.
+
+    Given a grid of pixel values, the carving mode, and the
+    number of seams to insert, this function simulates
+    removing that many seams, then duplicates every pixel the
+    simulation removed, in a single pass. Rather than repeating
+    the same seam, which a seam by seam insertion would keep
+    finding, the k cheapest seams to remove are each inserted
+    once. Insertions wider than the grid are split into
+    several simulations.
+
+    @param grid
+    The pixel grid to copy and insert seams into.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+
+    @param amt
+    The amt of seams to insert.
+
+    @returns the enlarged pixel grid.
+ */
+template <typename T>
+  FlexGrid<T> seamInsert(const FlexGrid<T>& grid, const CarvingMode& mode, const unsigned int& amt) {
+    return seamInsertAny(grid, mode, amt, nullptr, 1);
+  }
+
+/** Runs the seam insertion algorithm across multiple threads.
+
+    @param grid
+    The pixel grid to copy and insert seams into.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+
+    @param amt
+    The amt of seams to insert.
+
+    @param pool
+    The thread pool to split calculations across.
+
+    @returns the enlarged pixel grid.
+ */
+template <typename T>
+  FlexGrid<T> seamInsert(const FlexGrid<T>& grid, const CarvingMode& mode, const unsigned int& amt,
+                         ThreadPool& pool) {
+    return seamInsertAny(grid, mode, amt, &pool, 1);
+  }
+
+/** Runs the seam insertion algorithm, removing several seams per pass while simulating.
+
+    @param grid
+    The pixel grid to copy and insert seams into.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+
+    @param amt
+    The amt of seams to insert.
+
+    @param pool
+    The thread pool to split calculations across.
+
+    @param batch
+    The maximum number of seams to remove per cost grid
+    while simulating.
+
+    @returns the enlarged pixel grid.
+ */
+template <typename T>
+  FlexGrid<T> seamInsert(const FlexGrid<T>& grid, const CarvingMode& mode, const unsigned int& amt,
+                         ThreadPool& pool, const unsigned int& batch) {
+    return seamInsertAny(grid, mode, amt, &pool, batch);
+  }
+
+/** Duplicates the pixels of the first seams of a removal order.
+
+    Every pixel removed by one of the first amt seams is
+    followed by a new pixel, the average of it and its next
+    neighbor along the row (vertical) or column (horizontal),
+    or a copy of it at the edge of the grid.
+
+    @param grid
+    The pixel grid to insert seams into.
+
+    @param order
+    The removal order of every pixel of the grid, as
+    recorded by CarvingEngine::getRemovalOrder.
+
+    @param amt
+    The number of seams to duplicate.
+
+    @param mode
+    The carving mode the order was recorded in.
+
+    @param r
+    The grid to store the enlarged pixel grid in.
+ */
+template <typename T>
+  void duplicateSeams(const FlexGrid<T>& grid, const FlexGrid<unsigned int>& order, const unsigned int& amt,
+                      const CarvingMode& mode, FlexGrid<T>& r) {
+    const unsigned int width = grid.getWidth();
+    const unsigned int height = grid.getHeight();
+    auto average = [](const T& a, const T& b) {
+      return static_cast<T>((static_cast<long long>(a) + b + 1) / 2);
+    };
+
+    if (mode == CarvingMode::VERTICAL) {
+      r.reshape(width + amt, height);
+      for (unsigned int h = 0; h < height; ++h) {
+        const T* in = grid.row(h);
+        const unsigned int* removed = order.row(h);
+        T* out = r.row(h);
+        for (unsigned int w = 0; w < width; ++w) {
+          *out++ = in[w];
+          if (removed[w] < amt) {
+            *out++ = average(in[w], in[std::min(w + 1, width - 1)]);
+          }
+        }
+      }
+      return;
+    }
+
+    // Walk the rows in order, tracking how far down each
+    // column of the result has been filled
+    r.reshape(width, height + amt);
+    std::vector<unsigned int> filled(width, 0);
+    for (unsigned int h = 0; h < height; ++h) {
+      const T* in = grid.row(h);
+      const T* below = grid.row(std::min(h + 1, height - 1));
+      const unsigned int* removed = order.row(h);
+      for (unsigned int w = 0; w < width; ++w) {
+        r(w, filled[w]++) = in[w];
+        if (removed[w] < amt) {
+          r(w, filled[w]++) = average(in[w], below[w]);
+        }
+      }
     }
-    return newGrid;
   }
 
 /** Calculates an energy grid.
@@ -67,37 +668,138 @@ template <typename T>
 
     @returns the calculated energy grid.
  */
-template <typename T>
-  FlexGrid<T> calcEnergy(const FlexGrid<T>& grid) {
+template <typename P, typename E>
+  FlexGrid<E> calcEnergy(const FlexGrid<P>& grid) {
     // Create a new grid of equal deminsions to serve as the
     // energy grid
-    FlexGrid<T> r(grid.getWidth(), grid.getHeight());
-    for (unsigned int h = 0; h < r.getHeight(); ++h) {
-      for (unsigned int w = 0; w < r.getWidth(); ++w) {
-        T cur = grid.getValAt(w, h);
-
-        // Gen diffs for each adjacent pixel
-        T left   =  w > 0                 ? cur - grid.getValAt(w - 1, h) : 0;
-        T right  =  w < r.getWidth() - 1  ? cur - grid.getValAt(w + 1, h) : 0;
-        T top    =  h > 0                 ? cur - grid.getValAt(w, h - 1) : 0;
-        T bottom =  h < r.getHeight() - 1 ? cur - grid.getValAt(w, h + 1) : 0;
-
-        // Make diffs absolute
-        left   = std::abs(left);
-        right  = std::abs(right);
-        top    = std::abs(top);
-        bottom = std::abs(bottom);
-
-        // Update the energy value for the current pixel
-        // based as calculated by the sum of the absolute
-        // value of the difference in value between the
-        // adjacent pixels
-        r.setValAt(w, h, left + right + top + bottom);
-      }
-    }
+    FlexGrid<E> r(grid.getWidth(), grid.getHeight());
+    calcEnergyInto(grid, r);
     return r;
   }
 
+/** Calculates an energy grid into an existing grid.
+
+    Allows an energy grid to be recalculated repeatedly,
+    reusing its memory whenever it is large enough.
+
+    @param grid
+    The pixel grid to base calculations off of.
+
+    @param r
+    The energy grid to store the results in.
+ */
+template <typename P, typename E>
+  void calcEnergyInto(const FlexGrid<P>& grid, FlexGrid<E>& r) {
+    r.reshape(grid.getWidth(), grid.getHeight());
+    calcEnergyRows(grid, r, 0, r.getHeight());
+  }
+
+/** Calculates an energy grid across multiple threads.
+
+    Splits the rows of the energy grid into chunks,
+    which are calculated independently of one another.
+
+    @param grid
+    The pixel grid to base calculations off of.
+
+    @param pool
+    The thread pool to split the calculation across.
+
+    @returns the calculated energy grid.
+ */
+template <typename P, typename E>
+  FlexGrid<E> calcEnergy(const FlexGrid<P>& grid, ThreadPool& pool) {
+    FlexGrid<E> r(grid.getWidth(), grid.getHeight());
+    calcEnergyInto(grid, r, pool);
+    return r;
+  }
+
+/** Calculates an energy grid into an existing grid across multiple threads.
+
+    Allows an energy grid to be recalculated repeatedly,
+    reusing its memory whenever it is large enough.
+
+    @param grid
+    The pixel grid to base calculations off of.
+
+    @param r
+    The energy grid to store the results in.
+
+    @param pool
+    The thread pool to split the calculation across.
+ */
+template <typename P, typename E>
+  void calcEnergyInto(const FlexGrid<P>& grid, FlexGrid<E>& r, ThreadPool& pool) {
+    r.reshape(grid.getWidth(), grid.getHeight());
+
+    // Create a few chunks per thread, so that uneven
+    // thread scheduling does not leave threads idle
+    const unsigned int chunks = std::max(1u, std::min(r.getHeight(), pool.size() * 4));
+    const unsigned int chunkLen = (r.getHeight() + chunks - 1) / chunks;
+
+    pool.run(chunks, [&](unsigned int chunk) {
+      const unsigned int first = std::min(chunk * chunkLen, r.getHeight());
+      calcEnergyRows(grid, r, first, std::min(first + chunkLen, r.getHeight()));
+    });
+  }
+
+/** Calculates a range of rows of an energy grid.
+
+    @param grid
+    The pixel grid to base calculations off of.
+
+    @param r
+    The energy grid to store the results in.
+
+    @param first
+    The first row to calculate.
+
+    @param last
+    One past the last row to calculate.
+ */
+template <typename P, typename E>
+  void calcEnergyRows(const FlexGrid<P>& grid, FlexGrid<E>& r, unsigned int first, unsigned int last) {
+    for (unsigned int h = first; h < last; ++h) {
+      // Grab the rows once, so that the kernel walks contiguous
+      // memory without any bounds checks. The first and last rows
+      // stand in for their own missing neighbors, resulting in
+      // a difference of 0
+      const P* cur  = grid.row(h);
+      const P* up   = h > 0                 ? grid.row(h - 1) : cur;
+      const P* down = h < r.getHeight() - 1 ? grid.row(h + 1) : cur;
+
+      // Update the energy values for the row, each calculated
+      // as the sum of the absolute value of the difference in
+      // value between the adjacent pixels
+      energyRow(up, cur, down, r.row(h), r.getWidth());
+    }
+  }
+
+/** Calculates the energy of a single pixel.
+
+    Uses the same formula as calcEnergy, for usage when
+    only a handful of energy values need refreshing.
+
+    @param grid
+    The pixel grid to base calculations off of.
+
+    @param w
+    The x quardinate of the pixel.
+
+    @param h
+    The y quardinate of the pixel.
+
+    @returns the energy of the pixel.
+ */
+template <typename P, typename E>
+  E calcEnergyAt(const FlexGrid<P>& grid, const unsigned int& w, const unsigned int& h) {
+    const P* cur  = grid.row(h);
+    const P* up   = h > 0                    ? grid.row(h - 1) : cur;
+    const P* down = h < grid.getHeight() - 1 ? grid.row(h + 1) : cur;
+
+    return energyAtScalar<P, E>(up, cur, down, w, grid.getWidth());
+  }
+
 /** Calculates a horizontal cost grid.
 
     Given an energy grid, this function
@@ -110,57 +812,63 @@ template <typename T>
 
     @returns the calculated horizontal cost grid.
  */
-template <typename T>
-  FlexGrid<T> calcCostH(const FlexGrid<T>& energy) {
+template <typename E, typename C>
+  FlexGrid<C> calcCostH(const FlexGrid<E>& energy) {
     // Create a new grid of equal deminisions to serve as the
     // cost grid
-    FlexGrid<T> r(energy.getWidth(), energy.getHeight());
-    for (unsigned int w = 0; w < r.getWidth(); ++w) {
-      for (unsigned int h = 0; h < r.getHeight(); ++h) {
-        // Initialize first column to match the first
-        // column on the energy grid, as these two
-        // start out the same
-        if (w < 1) {
-          r.setValAt(0, h, energy.getValAt(0, h));
-          continue;
-        }
+    FlexGrid<C> r(energy.getWidth(), energy.getHeight());
+    calcCostHInto(energy, r);
+    return r;
+  }
 
-        // Create a relative offset, for examining
-        // the previous column
-        auto wPos = w - 1;
+/** Calculates a horizontal cost grid into an existing grid.
 
-        // Establish constant variables for the current pixel's value
-        // and the neighboring pixel of the previous column
-        const T curVal = energy.getValAt(w, h);
-        const Optional<T> neighbor(r.getValAt(wPos, h));
+    @param energy
+    The energy grid to base the cost grid off of.
 
-        // Establish optional variables for the relative pixel
-        // above and below the neighboring pixel, these values
-        // must be optional to account for values which
-        // go past the grid's bounds
-        Optional<T> above;
-        Optional<T> below;
+    @param r
+    The cost grid to store the results in.
+ */
+template <typename E, typename C>
+  void calcCostHInto(const FlexGrid<E>& energy, FlexGrid<C>& r) {
+    r.reshape(energy.getWidth(), energy.getHeight());
+    for (unsigned int w = 0; w < r.getWidth(); ++w) {
+      // Grab views of the columns being worked with, so that
+      // the inner loop avoids any bounds checks
+      const StridedView<const E> eCol = energy.getCol(w);
+      const StridedView<C> col = r.getCol(w);
+
+      // Initialize first column to match the first
+      // column on the energy grid, as these two
+      // start out the same
+      if (w < 1) {
+        for (unsigned int h = 0; h < r.getHeight(); ++h) {
+          col[h] = eCol[h];
+        }
+        continue;
+      }
 
-        // Enable the respective optional(s) values if they
-        // are within the bounds of the grid
+      // Create a view of the previous column
+      const StridedView<C> prev = r.getCol(w - 1);
+
+      for (unsigned int h = 0; h < r.getHeight(); ++h) {
+        // Find the minimum value of the previous column's
+        // neighboring pixel, and the relative pixels above
+        // and below it which are within the bounds of the grid
+        C minVal = prev[h];
         if (h > 0) {
-          above.setVal(r.getValAt(wPos, h - 1));
+          minVal = std::min(minVal, prev[h - 1]);
         }
         if (h < r.getHeight() - 1) {
-          below.setVal(r.getValAt(wPos, h + 1));
+          minVal = std::min(minVal, prev[h + 1]);
         }
 
-        // Find the minimum value of the previous iterations
-        // relative pixels
-        T minVal = std::min({above, neighbor, below}).getVal();
-
         // Update the value for this cost grid to be equal to
         // the min, plus the value held at the current
         // position of the energy grid
-        r.setValAt(w, h, curVal + minVal);
+        col[h] = eCol[h] + minVal;
       }
     }
-    return r;
   }
 
 /** Calculates a vertical cost grid.
@@ -175,57 +883,44 @@ template <typename T>
 
     @returns the calculated vertical cost grid.
  */
-template <typename T>
-  FlexGrid<T> calcCostV(const FlexGrid<T>& energy) {
+template <typename E, typename C>
+  FlexGrid<C> calcCostV(const FlexGrid<E>& energy) {
     // Create a new grid of equal deminisions to serve as the
     // cost grid
-    FlexGrid<T> r(energy.getWidth(), energy.getHeight());
-    for (unsigned int h = 0; h < r.getHeight(); ++h) {
-      for (unsigned int w = 0; w < r.getWidth(); ++w) {
-        // Initialize first row to match the first
-        // column on the energy grid, as these two
-        // start out the same
-        if (h < 1) {
-          r.setValAt(w, 0, energy.getValAt(w, 0));
-          continue;
-        }
-
-        // Create a relative offset, for examining
-        // the previous row
-        auto hPos = h - 1;
-
-        // Establish constant variables for the current pixel's value
-        // and the neighboring pixel of the previous row
-        const T curVal = energy.getValAt(w, h);
-        const Optional<T> neighbor(r.getValAt(w, hPos));
-
-        // Establish optional variables for the relative pixel
-        // left and right of the neighboring pixel, these values
-        // must be optional to account for values which
-        // go past the grid's bounds
-        Optional<T> left;
-        Optional<T> right;
+    FlexGrid<C> r(energy.getWidth(), energy.getHeight());
+    calcCostVInto(energy, r);
+    return r;
+  }
 
-        // Enable the respective optional(s) values if they
-        // are within the bounds of the grid
-        if (w > 0) {
-          left.setVal(r.getValAt(w - 1, hPos));
-        }
-        if (w < r.getWidth() - 1) {
-          right.setVal(r.getValAt(w + 1, hPos));
-        }
+/** Calculates a vertical cost grid into an existing grid.
 
-        // Find the minimum value of the previous iterations
-        // relative pixels
-        T minVal = std::min({left, neighbor, right}).getVal();
+    @param energy
+    The energy grid to base the cost grid off of.
 
-        // Update the value for this cost grid to be equal to
-        // the min, plus the value held at the current
-        // position of the energy grid
-        r.setValAt(w, h, curVal + minVal);
+    @param r
+    The cost grid to store the results in.
+ */
+template <typename E, typename C>
+  void calcCostVInto(const FlexGrid<E>& energy, FlexGrid<C>& r) {
+    r.reshape(energy.getWidth(), energy.getHeight());
+    for (unsigned int h = 0; h < r.getHeight(); ++h) {
+      const E* eRow = energy.row(h);
+      C* out = r.row(h);
+
+      // Initialize first row to match the first
+      // row on the energy grid, as these two
+      // start out the same
+      if (h < 1) {
+        std::copy(eRow, eRow + r.getWidth(), out);
+        continue;
       }
+
+      // Update the costs for this row to be equal to the
+      // value held at the same position of the energy grid,
+      // plus the minimum of the previous row's neighboring
+      // pixel, and the relative pixels left and right of it
+      costRow(eRow, r.row(h - 1), out, r.getWidth(), true, true);
     }
-    return r;
   }
 
 /** Calculates a vertical or horizontal cost grid.
@@ -244,38 +939,325 @@ template <typename T>
 
     @returns the calculated vertical or horizontal cost grid.
  */
-template <typename T>
-  FlexGrid<T> calcCost(const FlexGrid<T>& grid, const CarvingMode& mode) {
+template <typename E, typename C>
+  FlexGrid<C> calcCost(const FlexGrid<E>& grid, const CarvingMode& mode) {
+    FlexGrid<C> r(grid.getWidth(), grid.getHeight());
+    calcCostInto(grid, r, mode);
+    return r;
+  }
+
+/** Calculates a vertical or horizontal cost grid into an existing grid.
+
+    Allows a cost grid to be recalculated repeatedly,
+    reusing its memory whenever it is large enough.
+
+    @param energy
+    The energy grid to base the cost grid off of.
+
+    @param r
+    The cost grid to store the results in.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+ */
+template <typename E, typename C>
+  void calcCostInto(const FlexGrid<E>& energy, FlexGrid<C>& r, const CarvingMode& mode) {
     // Pick the proper cost matrix generation function
     // based on the carving mode
     switch (mode) {
       case CarvingMode::HORIZONTAL:
-        return calcCostH(grid);
+        calcCostHInto(energy, r);
+        return;
       case CarvingMode::VERTICAL:
-        return calcCostV(grid);
+        calcCostVInto(energy, r);
+        return;
     }
     throw std::runtime_error("Invalid Carving Mode!");
   }
 
-/** Performs a horizontal seam removal.
+/** Calculates a cost grid in tiles across multiple threads.
 
-    Given a pixel grid, and a cost grid.
-    This function then uses the cost grid
-    to to discover and removal the seam
-    of least significance from the pixel grid.
+    Each line of a cost grid (a row for vertical carving, a
+    column for horizontal carving) only depends upon the
+    previous line, so the cells of a line may all be
+    calculated at once.
+
+    Rather than synchronizing after every line, lines are
+    processed in bands. Every line of a band is split into
+    tiles, and each tile is calculated by a single task,
+    along with a triangular halo of the neighboring tiles'
+    cells, which shrinks by one cell per line. The halo
+    makes each task independent of its neighbors, reducing
+    synchronization to one barrier per band. Halo cells are
+    kept in task local buffers, only the tile's own cells
+    are written to the cost grid.
+
+    @param energy
+    The energy grid to base the cost grid off of.
+
+    @param r
+    The cost grid to store the results in, of equal
+    deminsions to the energy grid.
+
+    @param pool
+    The thread pool to split the calculation across.
+ */
+template <bool VERTICAL, typename E, typename C>
+  void calcCostTiled(const FlexGrid<E>& energy, FlexGrid<C>& r, ThreadPool& pool) {
+    const unsigned int BAND = 32;
+    const unsigned int MIN_TILE = 256;
+
+    const unsigned int lines = VERTICAL ? energy.getHeight() : energy.getWidth();
+    const int len = VERTICAL ? energy.getWidth() : energy.getHeight();
+    if (lines == 0 || len == 0) {
+      return;
+    }
+
+    const unsigned int tiles = std::max(1u, std::min(pool.size() * 2, (len + MIN_TILE - 1) / MIN_TILE));
+    const int tileLen = (len + tiles - 1) / tiles;
+
+    // Access a cell by line and position within the line
+    auto energyAt = [&energy](unsigned int line, int pos) -> E {
+      return VERTICAL ? energy(pos, line) : energy(line, pos);
+    };
+    auto ref = [&r](unsigned int line, int pos) -> C& {
+      return VERTICAL ? r(pos, line) : r(line, pos);
+    };
+
+    for (unsigned int band = 0; band < lines; band += BAND) {
+      const int bandLen = std::min(BAND, lines - band);
+
+      pool.run(tiles, [&](unsigned int tile) {
+        const int x0 = std::min<int>(tile * tileLen, len);
+        const int x1 = std::min(x0 + tileLen, len);
+        if (x0 >= x1) {
+          return;
+        }
+
+        // The widest range calculated by this task, the
+        // tile along with its first line's halo
+        const int lo = std::max(x0 - (bandLen - 1), 0);
+        const int hi = std::min(x1 + (bandLen - 1), len);
+        std::vector<C> prev(hi - lo);
+        std::vector<C> cur(hi - lo);
+
+        for (int i = 0; i < bandLen; ++i) {
+          const unsigned int line = band + i;
+          const int shrink = bandLen - 1 - i;
+          const int cLo = std::max(x0 - shrink, 0);
+          const int cHi = std::min(x1 + shrink, len);
+
+          // Rows are contiguous, so vertical runs are handed
+          // to the vectorized kernel
+          if (VERTICAL && line > 0) {
+            const C* prevRun = i == 0 ? r.row(line - 1) + cLo : prev.data() + (cLo - lo);
+            costRow(energy.row(line) + cLo, prevRun, cur.data() + (cLo - lo),
+                    cHi - cLo, cLo == 0, cHi == len);
+            std::copy(cur.begin() + (x0 - lo), cur.begin() + (x1 - lo), r.row(line) + x0);
+            std::swap(prev, cur);
+            continue;
+          }
+
+          for (int x = cLo; x < cHi; ++x) {
+            C val = energyAt(line, x);
+            if (line > 0) {
+              // The first line of a band builds upon the
+              // previous band, which is complete
+              auto prevAt = [&](int pos) -> C {
+                return i == 0 ? ref(line - 1, pos) : prev[pos - lo];
+              };
+
+              C minVal = prevAt(x);
+              if (x > 0) {
+                minVal = std::min(minVal, prevAt(x - 1));
+              }
+              if (x < len - 1) {
+                minVal = std::min(minVal, prevAt(x + 1));
+              }
+              val += minVal;
+            }
+
+            cur[x - lo] = val;
+            if (x >= x0 && x < x1) {
+              ref(line, x) = val;
+            }
+          }
+          std::swap(prev, cur);
+        }
+      });
+    }
+  }
+
+/** Calculates a vertical or horizontal cost grid across multiple threads.
+
+    Produces the same cost grid as the single threaded
+    calcCost, but splits the calculation across
+    the provided thread pool.
+
+    @param energy
+    The energy grid to base the cost grid off of.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+
+    @param pool
+    The thread pool to split the calculation across.
+
+    @returns the calculated vertical or horizontal cost grid.
+ */
+template <typename E, typename C>
+  FlexGrid<C> calcCost(const FlexGrid<E>& energy, const CarvingMode& mode, ThreadPool& pool) {
+    FlexGrid<C> r(energy.getWidth(), energy.getHeight());
+    calcCostInto(energy, r, mode, pool);
+    return r;
+  }
+
+/** Calculates a vertical or horizontal cost grid into an existing grid.
+
+    Allows a cost grid to be recalculated repeatedly,
+    reusing its memory whenever it is large enough.
+
+    @param energy
+    The energy grid to base the cost grid off of.
+
+    @param r
+    The cost grid to store the results in.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+
+    @param pool
+    The thread pool to split the calculation across.
+ */
+template <typename E, typename C>
+  void calcCostInto(const FlexGrid<E>& energy, FlexGrid<C>& r, const CarvingMode& mode, ThreadPool& pool) {
+    r.reshape(energy.getWidth(), energy.getHeight());
+
+    switch (mode) {
+      case CarvingMode::HORIZONTAL:
+        calcCostTiled<false>(energy, r, pool);
+        return;
+      case CarvingMode::VERTICAL:
+        calcCostTiled<true>(energy, r, pool);
+        return;
+    }
+    throw std::runtime_error("Invalid Carving Mode!");
+  }
 
-    The cost grid should be calculated with
-    the horizontal carving mode for
-    proper seam removal.
+/** Calculates a vertical cost grid straight from a pixel grid.
+
+    Each row's energy is calculated by the energy function into
+    a single scratch row, and consumed by the cost calculation
+    while it is still in cache, so no energy grid is ever held.
 
     @param grid
-    The pixel grid to remove from.
+    The pixel grid to base the cost grid off of.
+
+    @param r
+    The cost grid to store the results in.
+ */
+template <typename F, typename P, typename C>
+  void calcCostFused(const FlexGrid<P>& grid, FlexGrid<C>& r) {
+    typedef typename EnergyOf<P>::type E;
+
+    const unsigned int width = grid.getWidth();
+    const unsigned int height = grid.getHeight();
+    r.reshape(width, height);
+
+    std::vector<E> scratch(width);
+    for (unsigned int h = 0; h < height; ++h) {
+      const P* cur  = grid.row(h);
+      const P* up   = h > 0          ? grid.row(h - 1) : cur;
+      const P* down = h < height - 1 ? grid.row(h + 1) : cur;
+      F::costRun(up, cur, down, h > 0 ? r.row(h - 1) : nullptr, r.row(h), scratch.data(), 0, width, width);
+    }
+  }
+
+/** Calculates a vertical cost grid straight from a pixel grid across multiple threads.
+
+    Produces the same cost grid as the single threaded
+    calcCostFused, splitting rows into bands of tiles with a
+    triangular halo, as calcCostTiled does. Each task keeps
+    its own scratch and halo rows, reused for every band.
+
+    @param grid
+    The pixel grid to base the cost grid off of.
+
+    @param r
+    The cost grid to store the results in.
+
+    @param pool
+    The thread pool to split the calculation across.
+ */
+template <typename F, typename P, typename C>
+  void calcCostFused(const FlexGrid<P>& grid, FlexGrid<C>& r, ThreadPool& pool) {
+    typedef typename EnergyOf<P>::type E;
+    const unsigned int BAND = 32;
+    const unsigned int MIN_TILE = 256;
+
+    const unsigned int width = grid.getWidth();
+    const unsigned int height = grid.getHeight();
+    r.reshape(width, height);
+    if (width == 0 || height == 0) {
+      return;
+    }
+
+    const unsigned int tiles = std::max(1u, std::min(pool.size() * 2, (width + MIN_TILE - 1) / MIN_TILE));
+    const unsigned int tileLen = (width + tiles - 1) / tiles;
+
+    std::vector<std::vector<C>> prevs(tiles, std::vector<C>(width));
+    std::vector<std::vector<C>> curs(tiles, std::vector<C>(width));
+    std::vector<std::vector<E>> scratches(tiles, std::vector<E>(width));
+
+    for (unsigned int band = 0; band < height; band += BAND) {
+      const unsigned int bandLen = std::min(BAND, height - band);
+
+      pool.run(tiles, [&](unsigned int tile) {
+        const unsigned int x0 = std::min(tile * tileLen, width);
+        const unsigned int x1 = std::min(x0 + tileLen, width);
+        if (x0 >= x1) {
+          return;
+        }
+
+        std::vector<C>& prev = prevs[tile];
+        std::vector<C>& cur = curs[tile];
+        for (unsigned int i = 0; i < bandLen; ++i) {
+          const unsigned int h = band + i;
+          const unsigned int shrink = bandLen - 1 - i;
+          const unsigned int cLo = x0 > shrink ? x0 - shrink : 0;
+          const unsigned int cHi = std::min(x1 + shrink, width);
+
+          // The first line of a band builds upon the
+          // previous band, which is complete
+          const P* row  = grid.row(h);
+          const P* up   = h > 0          ? grid.row(h - 1) : row;
+          const P* down = h < height - 1 ? grid.row(h + 1) : row;
+          const C* before = h == 0 ? nullptr : i == 0 ? r.row(h - 1) : prev.data();
+          F::costRun(up, row, down, before, cur.data(), scratches[tile].data(), cLo, cHi, width);
+
+          std::copy(cur.begin() + x0, cur.begin() + x1, r.row(h) + x0);
+          std::swap(prev, cur);
+        }
+      });
+    }
+  }
+
+/** Traces a horizontal seam.
+
+    Given a cost grid calculated with the horizontal
+    carving mode, this function discovers the seam
+    of least significance, without removing it.
 
     @param cost
     The cost grid to use for seam discovery.
+
+    @param seam
+    Set to the row of the seam in every column.
  */
 template <typename T>
-  void traceBackRemH(FlexGrid<T>& grid, const FlexGrid<T>& cost) {
+  void traceSeamH(const FlexGrid<T>& cost, std::vector<unsigned int>& seam) {
+    seam.resize(cost.getWidth());
+
     // Create a variable to keep track of the position
     // to check for the next iteration
     unsigned int next = 0;
@@ -283,29 +1265,27 @@ template <typename T>
     // Finding starting point by locating the smallest
     // cost value in the last column
     for (unsigned int h = 0; h < cost.getHeight(); ++h) {
-      auto val = cost.getValAt(cost.getWidth() - 1, h);
-      auto curVal = cost.getValAt(cost.getWidth() - 1, next);
+      auto val = cost(cost.getWidth() - 1, h);
+      auto curVal = cost(cost.getWidth() - 1, next);
 
       if (val < curVal) {
         next = h;
       }
     }
 
-    // Remove the respective pixel in the seam, row by row
-    for (unsigned int w = grid.getWidth() - 1; w + 1 > 0; --w) {
-      // Create a temporary value to hold
-      // the position to check for the next iteration
-      unsigned int newNext = 0;
+    // Record the respective pixel in the seam, column by column
+    for (unsigned int w = cost.getWidth() - 1; w + 1 > 0; --w) {
+      seam[w] = next;
 
       // Ensure we're not outside of the bounds of the grid
       if (w > 0) {
         // Create a relative offset, for examining
-        // the previous row
+        // the previous column
         auto wPos = w - 1;
 
         // Establish a constant variable for the current
-        // the neighboring pixel of the previous row
-        const Optional<T> center(cost.getValAt(wPos, next));
+        // the neighboring pixel of the previous column
+        const Optional<T> center(cost(wPos, next));
 
         // Establish optional variables for the relative pixel
         // above and below the neighboring pixel, these values
@@ -317,10 +1297,10 @@ template <typename T>
         // Enable the respective optional(s) values if they
         // are within the bounds of the cost grid
         if (next > 0) {
-          above.setVal(cost.getValAt(wPos, next - 1));
+          above.setVal(cost(wPos, next - 1));
         }
         if (next < cost.getHeight() - 1) {
-          below.setVal(cost.getValAt(wPos, next + 1));
+          below.setVal(cost(wPos, next + 1));
         }
 
         // Find the minimum value of the next iterations
@@ -331,78 +1311,55 @@ template <typename T>
         // Pick the next positon to look at based
         // on the discovered path
         if (minVal == above) {
-          newNext = next - 1;
+          next = next - 1;
         } else if (minVal == below) {
-          newNext = next + 1;
-        } else {
-          newNext = next;
+          next = next + 1;
         }
       }
-
-      // Collapse the row by shifting all values in the column
-      // up after the currently targeted position in such a
-      // way that the removed seam pixel is overriden
-      for (unsigned int h = next + 1; h < grid.getHeight(); ++h) {
-        grid.setValAt(w, h - 1, grid.getValAt(w, h));
-      }
-      // Update the next position based off of the temporary
-      // value
-      next = newNext;
     }
-    // Resize the grid so that the last row which now contains
-    // duplicate data is dropped
-    grid.setHeight(grid.getHeight() - 1);
   }
 
-/** Performs a vertical seam removal.
-
-    Given a pixel grid, and a cost grid.
-    This function then uses the cost grid
-    to to discover and removal the seam
-    of least significance from the pixel grid.
+/** Traces a vertical seam.
 
-    The cost grid should be calculated with
-    the vertical carving mode for
-    proper seam removal.
-
-    @param grid
-    The pixel grid to remove from.
+    Given a cost grid calculated with the vertical
+    carving mode, this function discovers the seam
+    of least significance, without removing it.
 
     @param cost
     The cost grid to use for seam discovery.
+
+    @param seam
+    Set to the column of the seam in every row.
  */
 template <typename T>
-  void traceBackRemV(FlexGrid<T>& grid, const FlexGrid<T>& cost) {
+  void traceSeamV(const FlexGrid<T>& cost, std::vector<unsigned int>& seam) {
+    seam.resize(cost.getHeight());
+
     // Create a variable to keep track of the position
     // to check for the next iteration
     unsigned int next = 0;
 
     // Finding starting point by locating the smallest
     // cost value in the last row
+    const T* last = cost.row(cost.getHeight() - 1);
     for (unsigned int w = cost.getWidth() - 1; w + 1 > 0; --w) {
-      auto val = cost.getValAt(w, cost.getHeight() - 1);
-      auto curVal = cost.getValAt(next, cost.getHeight() - 1);
-
-      if (val < curVal) {
+      if (last[w] < last[next]) {
         next = w;
       }
     }
 
-    // Remove the respective pixel in the seam, column by column
-    for (unsigned int h = grid.getHeight() - 1; h + 1 > 0; --h) {
-      // Create a temporary value to hold
-      // the position to check for the next iteration
-      unsigned int newNext = 0;
+    // Record the respective pixel in the seam, row by row
+    for (unsigned int h = cost.getHeight() - 1; h + 1 > 0; --h) {
+      seam[h] = next;
 
       // Ensure we're not outside of the bounds of the grid
       if (h > 0) {
-        // Create a relative offset, for examining
-        // the previous column
-        auto hPos = h - 1;
+        // Grab the previous row
+        const T* prev = cost.row(h - 1);
 
         // Establish a constant variable for the current
-        // the neighboring pixel of the previous column
-        const Optional<T> center(cost.getValAt(next, hPos));
+        // the neighboring pixel of the previous row
+        const Optional<T> center(prev[next]);
 
         // Establish optional variables for the relative pixel
         // left and right of the neighboring pixel, these values
@@ -414,10 +1371,10 @@ template <typename T>
         // Enable the respective optional(s) values if they
         // are within the bounds of the cost grid
         if (next > 0) {
-          left.setVal(cost.getValAt(next - 1, hPos));
+          left.setVal(prev[next - 1]);
         }
         if (next < cost.getWidth() - 1) {
-          right.setVal(cost.getValAt(next + 1, hPos));
+          right.setVal(prev[next + 1]);
         }
 
         // Find the minimum value of the next iterations
@@ -428,27 +1385,123 @@ template <typename T>
         // Pick the next positon to look at based
         // on the discovered path
         if (minVal == left) {
-          newNext = next - 1;
-        } else if (minVal == center) {
-          newNext = next;
-        } else {
-          newNext = next + 1;
+          next = next - 1;
+        } else if (minVal != center) {
+          next = next + 1;
         }
       }
+    }
+  }
+
+/** Traces a vertical or horizontal seam.
+
+    Given a cost grid, and the carving mode it was
+    calculated with, this function discovers the seam
+    of least significance, without removing it.
+
+    @param cost
+    The cost grid to use for seam discovery.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+
+    @param seam
+    Set to the column of the seam in every row for
+    vertical seams, or the row of the seam in every
+    column for horizontal seams.
+ */
+template <typename T>
+  void traceSeam(const FlexGrid<T>& cost, const CarvingMode& mode, std::vector<unsigned int>& seam) {
+    switch (mode) {
+      case CarvingMode::HORIZONTAL:
+        traceSeamH(cost, seam);
+        return;
+      case CarvingMode::VERTICAL:
+        traceSeamV(cost, seam);
+        return;
+    }
+    throw std::runtime_error("Invalid Carving Mode!");
+  }
+
+/** Removes a horizontal seam from a pixel grid.
+
+    Rather than shifting each column up past the seam, which
+    would walk the grid against its row-major layout, rows are
+    processed top to bottom, each pulling up the cells of the
+    row below it which lie below the seam. Every pass then
+    reads and writes contiguous rows.
+
+    @param grid
+    The pixel grid to remove from.
 
-      // Collapse the column by shifting all values in the row
-      // to the left after the currently targeted position
-      // in such a way that the removed seam pixel is overriden
-      for (unsigned int w = next + 1; w < grid.getWidth(); ++w) {
-        grid.setValAt(w - 1, h, grid.getValAt(w, h));
+    @param seam
+    The row of the seam in every column.
+ */
+template <typename T>
+  void compactSeamH(FlexGrid<T>& grid, const std::vector<unsigned int>& seam) {
+    const unsigned int width = grid.getWidth();
+    const unsigned int top = *std::min_element(seam.begin(), seam.end());
+
+    // Rows above the seam's highest point are unaffected
+    for (unsigned int h = top; h + 1 < grid.getHeight(); ++h) {
+      T* row = grid.row(h);
+      const T* below = grid.row(h + 1);
+      for (unsigned int w = 0; w < width; ++w) {
+        row[w] = seam[w] <= h ? below[w] : row[w];
       }
-      // Update the next position based off of the temporary
-      // value
-      next = newNext;
     }
-    // Resize the grid so that the last column which now contains
-    // duplicate data is dropped
-    grid.setWidth(grid.getWidth() - 1);
+    // Drop the last row, which now contains duplicate data
+    grid.setHeight(grid.getHeight() - 1);
+  }
+
+/** Removes a vertical seam from a pixel grid.
+
+    Collapses each row over the seam's position in it
+    with a single memmove.
+
+    @param grid
+    The pixel grid to remove from.
+
+    @param seam
+    The column of the seam in every row.
+ */
+template <typename T>
+  void compactSeamV(FlexGrid<T>& grid, const std::vector<unsigned int>& seam) {
+    static_assert(std::is_trivially_copyable<T>::value, "Grid values must be trivially copyable!");
+
+    const unsigned int width = grid.getWidth();
+    for (unsigned int h = 0; h < grid.getHeight(); ++h) {
+      T* row = grid.row(h);
+      std::memmove(row + seam[h], row + seam[h] + 1, (width - seam[h] - 1) * sizeof(T));
+    }
+    // Drop the last column, which now contains duplicate data
+    grid.setWidth(width - 1);
+  }
+
+/** Removes a vertical or horizontal seam from a pixel grid.
+
+    The grid is shrunk in place, without reallocating.
+
+    @param grid
+    The pixel grid to remove from.
+
+    @param seam
+    The seam, as discovered by traceSeam.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+ */
+template <typename T>
+  void compactSeam(FlexGrid<T>& grid, const std::vector<unsigned int>& seam, const CarvingMode& mode) {
+    switch (mode) {
+      case CarvingMode::HORIZONTAL:
+        compactSeamH(grid, seam);
+        return;
+      case CarvingMode::VERTICAL:
+        compactSeamV(grid, seam);
+        return;
+    }
+    throw std::runtime_error("Invalid Carving Mode!");
   }
 
 /** Performs a vertical or horizontal seam removal.
@@ -472,16 +1525,46 @@ template <typename T>
     @param mode
     The carving mode to utalize (vertical/horizontal).
  */
-template <typename T>
-  void traceBackRem(FlexGrid<T>& grid, const FlexGrid<T>& cost, const CarvingMode& mode) {
-    // Pick the proper removal function based on the carving mode
-    switch (mode) {
-      case CarvingMode::HORIZONTAL:
-        traceBackRemH(grid, cost);
-        return;
-      case CarvingMode::VERTICAL:
-        traceBackRemV(grid, cost);
-        return;
-    }
-    throw std::runtime_error("Invalid Carving Mode!");
+template <typename T, typename C>
+  void traceBackRem(FlexGrid<T>& grid, const FlexGrid<C>& cost, const CarvingMode& mode) {
+    // Discover the seam, then collapse the grid over it
+    std::vector<unsigned int> seam;
+    traceSeam(cost, mode, seam);
+    compactSeam(grid, seam, mode);
+  }
+
+/** Performs a horizontal seam removal.
+
+    Given a pixel grid, and a cost grid calculated
+    with the horizontal carving mode. This function
+    then uses the cost grid to to discover and remove
+    the seam of least significance from the pixel grid.
+
+    @param grid
+    The pixel grid to remove from.
+
+    @param cost
+    The cost grid to use for seam discovery.
+ */
+template <typename T, typename C>
+  void traceBackRemH(FlexGrid<T>& grid, const FlexGrid<C>& cost) {
+    traceBackRem(grid, cost, CarvingMode::HORIZONTAL);
+  }
+
+/** Performs a vertical seam removal.
+
+    Given a pixel grid, and a cost grid calculated
+    with the vertical carving mode. This function
+    then uses the cost grid to to discover and remove
+    the seam of least significance from the pixel grid.
+
+    @param grid
+    The pixel grid to remove from.
+
+    @param cost
+    The cost grid to use for seam discovery.
+ */
+template <typename T, typename C>
+  void traceBackRemV(FlexGrid<T>& grid, const FlexGrid<C>& cost) {
+    traceBackRem(grid, cost, CarvingMode::VERTICAL);
   }
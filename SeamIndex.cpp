@@ -0,0 +1,198 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "SeamIndex.hpp"
+
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+
+#include "Util/BufferedWriter.hpp"
+#include "Util/MappedFile.hpp"
+
+namespace {
+  // Seam index files begin with this magic, followed by a
+  // version byte, a carving mode byte, an entry size byte and
+  // a reserved byte, then the width, height and seam count as
+  // little endian 32 bit values, and finally one little endian
+  // entry per pixel in row-major order
+  const char MAGIC[4] = {'S', 'I', 'D', 'X'};
+  const unsigned char VERSION = 1;
+  const std::size_t HEADER_LEN = 20;
+
+  /** Gets the fewest bytes able to hold every entry.
+   */
+  unsigned int entryBytes(unsigned int maxVal) {
+    return maxVal <= 0xFF ? 1 : (maxVal <= 0xFFFF ? 2 : 4);
+  }
+
+  /** Writes a little endian value of the provided size.
+   */
+  void encode(char* out, unsigned int val, unsigned int bytes) {
+    for (unsigned int i = 0; i < bytes; ++i) {
+      out[i] = static_cast<char>((val >> (8 * i)) & 0xFF);
+    }
+  }
+
+  /** Reads a little endian value of the provided size.
+   */
+  unsigned int decode(const char* in, unsigned int bytes) {
+    unsigned int val = 0;
+    for (unsigned int i = 0; i < bytes; ++i) {
+      val |= static_cast<unsigned int>(static_cast<unsigned char>(in[i])) << (8 * i);
+    }
+    return val;
+  }
+}
+
+/** Construct a new SeamIndex object.
+
+    Constructs a new SeamIndex object, which records
+    no seams, for usage with build or loadFile.
+ */
+SeamIndex::SeamIndex() : mode(CarvingMode::VERTICAL), seams(0), order(0, 0) { }
+
+/** Gets the carving mode the index was built with.
+
+    @returns the carving mode.
+ */
+CarvingMode SeamIndex::getMode() const {
+  return mode;
+}
+
+/** Gets the number of seams recorded by the index.
+
+    @returns the number of seams.
+ */
+unsigned int SeamIndex::getSeams() const {
+  return seams;
+}
+
+/** Gets the width of the image the index was built from.
+
+    @returns the width.
+ */
+unsigned int SeamIndex::getWidth() const {
+  return order.getWidth();
+}
+
+/** Gets the height of the image the index was built from.
+
+    @returns the height.
+ */
+unsigned int SeamIndex::getHeight() const {
+  return order.getHeight();
+}
+
+/** Loads a seam index file.
+
+    Rejects files whose entries could not have been recorded
+    by carving, so that retargeting never writes out of bounds.
+
+    @param path
+    The path of the file to load.
+ */
+void SeamIndex::loadFile(const std::string& path) {
+  MappedFile file(path);
+  const char* data = file.begin();
+  if (file.len() < HEADER_LEN || std::memcmp(data, MAGIC, sizeof(MAGIC)) != 0 ||
+      static_cast<unsigned char>(data[4]) != VERSION) {
+    throw std::runtime_error("Invalid seam index file!");
+  }
+
+  const unsigned char modeByte = data[5];
+  const unsigned int bytes = static_cast<unsigned char>(data[6]);
+  const unsigned int width = decode(data + 8, 4);
+  const unsigned int height = decode(data + 12, 4);
+  const unsigned int count = decode(data + 16, 4);
+  if (modeByte > 1 || (bytes != 1 && bytes != 2 && bytes != 4) ||
+      file.len() - HEADER_LEN != static_cast<std::size_t>(width) * height * bytes) {
+    throw std::runtime_error("Invalid seam index file!");
+  }
+
+  mode = modeByte == 0 ? CarvingMode::VERTICAL : CarvingMode::HORIZONTAL;
+  seams = count;
+  order.reshape(width, height);
+
+  // Every seam removes exactly one pixel from each row (vertical)
+  // or column (horizontal), so every line must hold every rank
+  // below the seam count exactly once, or retargeting would keep
+  // more or fewer pixels than the line has room for
+  const bool vertical = mode == CarvingMode::VERTICAL;
+  const unsigned int lines = vertical ? height : width;
+  std::vector<unsigned char> seen(static_cast<std::size_t>(lines) * seams, 0);
+  std::vector<unsigned int> ranked(lines, 0);
+
+  const char* in = data + HEADER_LEN;
+  for (unsigned int h = 0; h < height; ++h) {
+    unsigned int* row = order.row(h);
+    for (unsigned int w = 0; w < width; ++w, in += bytes) {
+      row[w] = decode(in, bytes);
+      if (row[w] > seams) {
+        throw std::runtime_error("Invalid seam index file!");
+      }
+      if (row[w] == seams) {
+        continue;
+      }
+      const unsigned int line = vertical ? h : w;
+      unsigned char& mark = seen[static_cast<std::size_t>(line) * seams + row[w]];
+      if (mark) {
+        throw std::runtime_error("Invalid seam index file!");
+      }
+      mark = 1;
+      ++ranked[line];
+    }
+  }
+  for (unsigned int line = 0; line < lines; ++line) {
+    if (ranked[line] != seams) {
+      throw std::runtime_error("Invalid seam index file!");
+    }
+  }
+}
+
+/** Exports the seam index into a file.
+
+    Every entry is stored in the fewest bytes able to hold
+    the seam count, so that indexes of up to 255 seams take
+    one byte per pixel.
+
+    @param path
+    The path of the file to create.
+ */
+void SeamIndex::exportFile(const std::string& path) const {
+  const unsigned int bytes = entryBytes(seams);
+
+  char header[HEADER_LEN] = {};
+  std::memcpy(header, MAGIC, sizeof(MAGIC));
+  header[4] = VERSION;
+  header[5] = mode == CarvingMode::VERTICAL ? 0 : 1;
+  header[6] = bytes;
+  encode(header + 8, order.getWidth(), 4);
+  encode(header + 12, order.getHeight(), 4);
+  encode(header + 16, seams, 4);
+
+  BufferedWriter out(path);
+  out.write(header, HEADER_LEN);
+
+  std::vector<char> line(static_cast<std::size_t>(order.getWidth()) * bytes);
+  for (unsigned int h = 0; h < order.getHeight(); ++h) {
+    const unsigned int* row = order.row(h);
+    for (unsigned int w = 0; w < order.getWidth(); ++w) {
+      encode(&line[static_cast<std::size_t>(w) * bytes], row[w], bytes);
+    }
+    out.write(line.data(), line.size());
+  }
+  out.close();
+}
@@ -0,0 +1,51 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SEAMINDEX_HPP
+#define SEAMINDEX_HPP
+
+#include <string>
+
+#include "SeamCarver.hpp"
+#include "Util/FlexGrid.hpp"
+#include "Util/ThreadPool.hpp"
+
+class SeamIndex {
+  CarvingMode mode;
+  unsigned int seams;
+  FlexGrid<unsigned int> order;
+public:
+  SeamIndex();
+
+  template <typename T>
+    void build(const FlexGrid<T>&, const CarvingMode&, const unsigned int&, ThreadPool&,
+               const unsigned int&);
+  template <typename T>
+    FlexGrid<T> retarget(const FlexGrid<T>&, const unsigned int&) const;
+
+  CarvingMode getMode() const;
+  unsigned int getSeams() const;
+  unsigned int getWidth() const;
+  unsigned int getHeight() const;
+
+  void loadFile(const std::string&);
+  void exportFile(const std::string&) const;
+private:
+  template <typename Engine>
+    void record(Engine&, const CarvingMode&, const unsigned int&, const unsigned int&);
+};
+
+#include "SeamIndex.ipp"
+#endif
@@ -0,0 +1,153 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <stdexcept>
+#include <vector>
+
+#include "CarvingEngine.hpp"
+
+/** Records the order in which seams are removed from a pixel grid.
+
+    Carves the grid once, removing the requested number of
+    seams, while labelling every pixel with the number of
+    seams removed before it. Afterwards, the grid may be
+    retargeted to any size down to the carved size without
+    recalculating any energy or cost grids.
+
+    @param grid
+    The pixel grid to carve.
+
+    @param mode
+    The carving mode to utalize (vertical/horizontal).
+
+    @param seams
+    The amount of seams to record, which bounds how
+    far the grid may later be retargeted.
+
+    @param pool
+    The thread pool to split calculations across.
+
+    @param batch
+    The maximum number of non-crossing seams to remove per
+    cost grid calculation.
+ */
+template <typename T>
+  void SeamIndex::build(const FlexGrid<T>& grid, const CarvingMode& mode, const unsigned int& seams,
+                        ThreadPool& pool, const unsigned int& batch) {
+    const unsigned int size = mode == CarvingMode::VERTICAL ? grid.getWidth() : grid.getHeight();
+    if (seams >= size) {
+      throw std::runtime_error("Cannot index every seam of the image!");
+    }
+
+    // Seams run the full length of the grid along the carving
+    // direction, which may overflow the usual cost type
+    typedef typename EnergyOf<T>::type E;
+    typedef typename CostOf<E>::type C;
+    const unsigned int length = mode == CarvingMode::VERTICAL ? grid.getHeight() : grid.getWidth();
+    if (needsWideCost<T>(length)) {
+      CarvingEngine<T, E, typename WideCostOf<C>::type> engine(grid, mode, pool);
+      record(engine, mode, seams, batch);
+    } else {
+      CarvingEngine<T, E, C> engine(grid, mode, pool);
+      record(engine, mode, seams, batch);
+    }
+  }
+
+/** Records the removal order of seams carved by an engine.
+
+    @param engine
+    The engine holding the grid to carve.
+
+    @param mode
+    The carving mode the engine was created with.
+
+    @param seams
+    The amount of seams to record.
+
+    @param batch
+    The maximum number of non-crossing seams to remove per
+    cost grid calculation.
+ */
+template <typename Engine>
+  void SeamIndex::record(Engine& engine, const CarvingMode& mode, const unsigned int& seams,
+                         const unsigned int& batch) {
+    engine.trackRemovals();
+    engine.removeSeams(seams, batch);
+
+    this->mode = mode;
+    this->seams = seams;
+    order = engine.getRemovalOrder();
+  }
+
+/** Retargets a pixel grid using the recorded seam order.
+
+    Keeps only the pixels which were removed after the first
+    size reducing seams, or never removed, in a single pass
+    over the grid. The result matches carving the grid
+    one seam at a time, when the index was built with a
+    batch size of 1.
+
+    @param grid
+    The pixel grid the index was built from.
+
+    @param size
+    The width (vertical) or height (horizontal) to
+    retarget to.
+
+    @returns the retargeted pixel grid.
+ */
+template <typename T>
+  FlexGrid<T> SeamIndex::retarget(const FlexGrid<T>& grid, const unsigned int& size) const {
+    if (grid.getWidth() != order.getWidth() || grid.getHeight() != order.getHeight()) {
+      throw std::runtime_error("Seam index does not match the image!");
+    }
+
+    const bool vertical = mode == CarvingMode::VERTICAL;
+    const unsigned int full = vertical ? grid.getWidth() : grid.getHeight();
+    if (size > full || full - size > seams) {
+      throw std::runtime_error("Seam index does not cover the requested size!");
+    }
+    const unsigned int removed = full - size;
+
+    if (vertical) {
+      FlexGrid<T> result(size, grid.getHeight());
+      for (unsigned int h = 0; h < grid.getHeight(); ++h) {
+        const T* src = grid.row(h);
+        const unsigned int* rank = order.row(h);
+        T* dst = result.row(h);
+        for (unsigned int w = 0; w < grid.getWidth(); ++w) {
+          if (rank[w] >= removed) {
+            *dst++ = src[w];
+          }
+        }
+      }
+      return result;
+    }
+
+    // Every column keeps its own write position, so that the
+    // grid is still read one row at a time
+    FlexGrid<T> result(grid.getWidth(), size);
+    std::vector<unsigned int> next(grid.getWidth(), 0);
+    for (unsigned int h = 0; h < grid.getHeight(); ++h) {
+      const T* src = grid.row(h);
+      const unsigned int* rank = order.row(h);
+      for (unsigned int w = 0; w < grid.getWidth(); ++w) {
+        if (rank[w] >= removed) {
+          result(w, next[w]++) = src[w];
+        }
+      }
+    }
+    return result;
+  }
@@ -0,0 +1,530 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#include "SequenceCarver.hpp"
+#include "CarvingEngine.hpp"
+#include "Util/BufferedWriter.hpp"
+#include "Util/MappedFile.hpp"
+#include "Util/RunHelpers.hpp"
+#include "Util/ThreadPool.hpp"
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+/** The mean difference between consecutive frames, as a
+    fraction of the grey scale value, beyond which the content
+    is considered changed, such as at a cut between scenes.
+ */
+const double CHANGED_DIFFERENCE = 0.1;
+
+/** A frame passed between the stages of the pipeline.
+ */
+struct Frame {
+  std::size_t index;
+  ImageLoader loader;
+};
+
+/** A queue of frames between two stages of the pipeline.
+
+    Holds at most a fixed number of frames, so that a fast
+    stage blocks rather than running ahead of a slow one.
+    Closing the queue wakes both stages, letting the consumer
+    drain the remaining frames and telling the producer to stop.
+ */
+class FrameQueue {
+  std::size_t limit;
+  std::deque<Frame> frames;
+  bool closed;
+  std::mutex lock;
+  std::condition_variable pushed;
+  std::condition_variable popped;
+public:
+  explicit FrameQueue(std::size_t limit) : limit(limit), closed(false) { }
+
+  /** Adds a frame, waiting for room.
+
+      @returns false if the queue was closed instead.
+   */
+  bool push(Frame&& frame) {
+    std::unique_lock<std::mutex> guard(lock);
+    popped.wait(guard, [&]() { return frames.size() < limit || closed; });
+    if (closed) {
+      return false;
+    }
+    frames.push_back(std::move(frame));
+    pushed.notify_one();
+    return true;
+  }
+
+  /** Takes the oldest frame, waiting for one to arrive.
+
+      @returns false if the queue was closed and emptied instead.
+   */
+  bool pop(Frame& frame) {
+    std::unique_lock<std::mutex> guard(lock);
+    pushed.wait(guard, [&]() { return !frames.empty() || closed; });
+    if (frames.empty()) {
+      return false;
+    }
+    frame = std::move(frames.front());
+    frames.pop_front();
+    popped.notify_one();
+    return true;
+  }
+
+  /** Closes the queue, no further frames may be added.
+   */
+  void close() {
+    std::lock_guard<std::mutex> guard(lock);
+    closed = true;
+    pushed.notify_all();
+    popped.notify_all();
+  }
+};
+
+/** The state carried from one frame to the next.
+
+    Each pixel and cost type keeps its own engine, along with
+    the last frame it carved, and the seams removed from it
+    in each direction.
+ */
+template <typename P, typename E = typename EnergyOf<P>::type, typename C = typename CostOf<E>::type>
+struct Track {
+  CarvingEngine<P, E, C> engine;
+  FlexGrid<P> previous;
+  std::size_t last;
+  bool valid;
+  std::vector<unsigned int> seams[2];
+  std::vector<C> costs[2];
+
+  explicit Track(ThreadPool& pool) : engine(pool), previous(0, 0), last(0), valid(false) { }
+};
+
+/** Checks whether the content of a frame differs from the frame before it.
+
+    @returns true if the mean absolute difference of their
+    pixels exceeds CHANGED_DIFFERENCE of the grey scale value.
+ */
+template <typename P>
+bool contentChanged(const FlexGrid<P>& previous, const FlexGrid<P>& grid, int greyScale) {
+  double sum = 0;
+  for (unsigned int h = 0; h < grid.getHeight(); ++h) {
+    const P* a = previous.row(h);
+    const P* b = grid.row(h);
+    std::uint64_t rowSum = 0;
+    for (unsigned int w = 0; w < grid.getWidth(); ++w) {
+      rowSum += a[w] > b[w] ? a[w] - b[w] : b[w] - a[w];
+    }
+    sum += rowSum;
+  }
+  const double cells = static_cast<double>(grid.getWidth()) * grid.getHeight();
+  return sum > CHANGED_DIFFERENCE * greyScale * cells;
+}
+
+/** Adds up how far each seam moved from the same seam of the previous frame.
+
+    @param total
+    The sum of the distances between the seams' columns
+    in every row, added to.
+
+    @param cells
+    The number of rows compared, added to.
+ */
+void addShift(const std::vector<unsigned int>& seams, const std::vector<unsigned int>& previous,
+              double& total, double& cells) {
+  const std::size_t count = std::min(seams.size(), previous.size());
+  for (std::size_t i = 0; i < count; ++i) {
+    total += seams[i] > previous[i] ? seams[i] - previous[i] : previous[i] - seams[i];
+  }
+  cells += count;
+}
+
+/** Carves a frame, following the seams of the frame before it.
+
+    Seams are guided by the previous frame's seams only when
+    that frame was carved by the same track, has the same
+    deminsions, and its content has not changed.
+ */
+template <typename P, typename E, typename C>
+void carveFrame(Track<P, E, C>& track, Frame& frame, unsigned int vert, unsigned int horiz,
+                unsigned int window, SequenceResult& result) {
+  const FlexGrid<P> grid = frame.loader.getGrid<P>();
+  result.inWidth = grid.getWidth();
+  result.inHeight = grid.getHeight();
+  if (vert >= grid.getWidth() || horiz >= grid.getHeight()) {
+    throw std::runtime_error("Cannot remove every column or row of the frame!");
+  }
+
+  const bool comparable = track.valid && track.last + 1 == frame.index &&
+                          track.previous.getWidth() == grid.getWidth() &&
+                          track.previous.getHeight() == grid.getHeight();
+  result.changed = comparable && contentChanged(track.previous, grid, frame.loader.getGreyScale());
+  const bool follow = comparable && !result.changed && window > 0;
+
+  double shift = 0;
+  double cells = 0;
+  CarvingEngine<P, E, C>& engine = track.engine;
+  for (int pass = 0; pass < 2; ++pass) {
+    if (follow) {
+      engine.followSeams(track.seams[pass], track.costs[pass], window);
+    }
+    if (pass == 0) {
+      engine.reset(grid, CarvingMode::VERTICAL);
+    } else {
+      engine.setMode(CarvingMode::HORIZONTAL);
+    }
+    engine.recordSeams();
+    engine.removeSeams(pass == 0 ? vert : horiz);
+    result.guided += engine.getGuidedSeams();
+
+    if (comparable) {
+      addShift(engine.getRecordedSeams(), track.seams[pass], shift, cells);
+    }
+    track.seams[pass] = engine.getRecordedSeams();
+    track.costs[pass] = engine.getRecordedCosts();
+  }
+  result.shift = cells > 0 ? shift / cells : -1;
+
+  frame.loader.setGrid(engine.getGrid());
+  result.outWidth = result.inWidth - vert;
+  result.outHeight = result.inHeight - horiz;
+
+  track.previous.assign(grid);
+  track.last = frame.index;
+  track.valid = true;
+}
+
+}
+
+/** Construct a new SequenceCarver object.
+
+    @param threads
+    The number of threads energy and cost grid calculations
+    are split across.
+
+    @param window
+    The number of pixels either side of the previous frame's
+    seams to search for each frame's seams within, 0 carves
+    every frame independently.
+ */
+SequenceCarver::SequenceCarver(const unsigned int& threads, const unsigned int& window) :
+  threads(std::max(1u, threads)),
+  window(window),
+  overrideFormat(false),
+  format(PgmFormat::ASCII) { }
+
+/** Sets the format every output frame is exported in.
+
+    Without an override, each output frame keeps the format
+    of its input frame. Multi-image streams are always
+    exported in binary.
+
+    @param format
+    The format to export in.
+ */
+void SequenceCarver::setFormat(const PgmFormat& format) {
+  this->format = format;
+  overrideFormat = true;
+}
+
+/** Adds a frame to the end of the sequence.
+
+    @param input
+    The frame to carve.
+
+    @param output
+    The file to export the carved frame to.
+ */
+void SequenceCarver::addFrame(const std::string& input, const std::string& output) {
+  inputs.push_back(input);
+  outputs.push_back(output);
+}
+
+/** Adds every frame listed in a file to the sequence.
+
+    Every line of the list holds an input file, optionally
+    followed by an output file, which otherwise is named
+    after the input file as in the single image mode. Blank
+    lines, and lines beginning with '#', are ignored.
+
+    @param path
+    The path of the list, or "-" to read it from
+    standard input.
+ */
+void SequenceCarver::loadList(const std::string& path) {
+  std::ifstream file;
+  if (path != "-") {
+    file.open(path);
+    if (!file) {
+      throw std::runtime_error("Unable to open " + path + "!");
+    }
+  }
+  std::istream& in = path == "-" ? std::cin : file;
+
+  std::string line;
+  for (unsigned int lineNum = 1; std::getline(in, line); ++lineNum) {
+    std::istringstream fields(line);
+
+    std::string input;
+    if (!(fields >> input) || input[0] == '#') {
+      continue;
+    }
+
+    std::string output;
+    std::string extra;
+    if (!(fields >> output)) {
+      output = processedName(input);
+    } else if (fields >> extra) {
+      throw std::runtime_error("Malformed frame list line " + std::to_string(lineNum) + "!");
+    }
+    addFrame(input, output);
+  }
+}
+
+/** Carves the frames of a multi-image PGM stream, instead of a list of frames.
+
+    @param input
+    The stream of concatenated binary (P5) frames to carve.
+
+    @param output
+    The file to export the stream of carved frames to.
+ */
+void SequenceCarver::setStream(const std::string& input, const std::string& output) {
+  streamInput = input;
+  streamOutput = output;
+}
+
+/** Carves every frame of the sequence.
+
+    The frames are pipelined across three stages, each on its
+    own thread: a reader loading frames, this thread carving
+    them, splitting each frame's energy and cost grids across
+    a thread pool, and a writer exporting them. Queues holding
+    at most two frames separate the stages, so that reading
+    and writing overlap with carving.
+
+    Frames are carved in order, each frame's seams following
+    the seams of the frame before it within the window, unless
+    the content between the frames changed, in which case the
+    frame is searched in full.
+
+    @param vert
+    The number of vertical seams to remove from each frame.
+
+    @param horiz
+    The number of horizontal seams to remove from each frame.
+
+    @param out
+    The stream to write the per frame and aggregate
+    report to.
+
+    @returns true if every frame was carved.
+ */
+bool SequenceCarver::run(const unsigned int& vert, const unsigned int& horiz, std::ostream& out) {
+  const bool streaming = !streamInput.empty();
+  if (streaming && overrideFormat && format == PgmFormat::ASCII) {
+    throw std::runtime_error("Multi-image streams are always exported as p5!");
+  }
+
+  std::vector<SequenceResult> results;
+  std::string readError;
+  std::string writeError;
+
+  FrameQueue loaded(2);
+  FrameQueue carved(2);
+
+  const Clock::time_point start = Clock::now();
+
+  std::thread reader([&]() {
+    try {
+      if (streaming) {
+        MappedFile file(streamInput);
+        const char* pos = file.begin();
+        for (std::size_t i = 0;; ++i) {
+          Frame frame;
+          frame.index = i;
+          if (!frame.loader.loadNext(pos, file.end()) || !loaded.push(std::move(frame))) {
+            break;
+          }
+        }
+      } else {
+        for (std::size_t i = 0; i < inputs.size(); ++i) {
+          Frame frame;
+          frame.index = i;
+          frame.loader.loadFile(inputs[i]);
+          if (!loaded.push(std::move(frame))) {
+            break;
+          }
+        }
+      }
+    } catch (const std::exception& e) {
+      readError = e.what();
+    }
+    loaded.close();
+  });
+
+  std::thread writer([&]() {
+    try {
+      std::unique_ptr<BufferedWriter> stream;
+      if (streaming) {
+        stream.reset(new BufferedWriter(streamOutput));
+      }
+
+      Frame frame;
+      while (carved.pop(frame)) {
+        if (streaming) {
+          frame.loader.setFormat(PgmFormat::BINARY);
+          frame.loader.exportInto(*stream, streamOutput);
+        } else {
+          if (overrideFormat) {
+            frame.loader.setFormat(format);
+          }
+          frame.loader.exportFile(outputs[frame.index]);
+        }
+      }
+
+      if (stream) {
+        stream->close();
+      }
+    } catch (const std::exception& e) {
+      writeError = e.what();
+    }
+    carved.close();
+  });
+
+  std::string carveError;
+  try {
+    ThreadPool pool(threads);
+    Track<std::uint8_t> narrow(pool);
+    Track<std::uint8_t, std::uint16_t, std::uint64_t> narrowWide(pool);
+    Track<std::uint16_t> wide(pool);
+    Track<std::uint16_t, std::uint32_t, std::uint64_t> widest(pool);
+
+    Frame frame;
+    while (loaded.pop(frame)) {
+      SequenceResult result = SequenceResult();
+      result.input = streaming ? streamInput : inputs[frame.index];
+      result.output = streaming ? streamOutput : outputs[frame.index];
+      result.seams = vert + horiz;
+
+      const Clock::time_point from = Clock::now();
+      const int longest = std::max(frame.loader.getWidth(), frame.loader.getHeight());
+      if (!frame.loader.isWide()) {
+        if (needsWideCost<std::uint8_t>(longest)) {
+          carveFrame(narrowWide, frame, vert, horiz, window, result);
+        } else {
+          carveFrame(narrow, frame, vert, horiz, window, result);
+        }
+      } else {
+        if (needsWideCost<std::uint16_t>(longest)) {
+          carveFrame(widest, frame, vert, horiz, window, result);
+        } else {
+          carveFrame(wide, frame, vert, horiz, window, result);
+        }
+      }
+      result.carveSecs = secsBetween(from, Clock::now());
+      results.push_back(result);
+
+      if (!carved.push(std::move(frame))) {
+        break;
+      }
+    }
+  } catch (const std::exception& e) {
+    carveError = e.what();
+  }
+  loaded.close();
+  carved.close();
+  reader.join();
+  writer.join();
+
+  report(out, results, secsBetween(start, Clock::now()));
+
+  const std::string& error = !readError.empty() ? readError : !carveError.empty() ? carveError : writeError;
+  if (!error.empty()) {
+    out << "Sequence stopped after " << results.size() << " frames, " << error << std::endl;
+    return false;
+  }
+  return true;
+}
+
+/** Writes the per frame and aggregate report.
+
+    Each frame reports how many of its seams followed the
+    seams of the frame before it, and how far its seams moved
+    from the previous frame's seams, on average per row, as a
+    measure of jitter.
+
+    @param out
+    The stream to write the report to.
+
+    @param results
+    The result of every carved frame, in order.
+
+    @param wallSecs
+    The wall time of the entire sequence.
+ */
+void SequenceCarver::report(std::ostream& out, const std::vector<SequenceResult>& results, double wallSecs) const {
+  const std::ios::fmtflags flags = out.flags();
+  const std::streamsize precision = out.precision();
+  out << std::fixed << std::setprecision(2);
+
+  double shift = 0;
+  unsigned int shifted = 0;
+  unsigned int guided = 0;
+  unsigned int seams = 0;
+  for (std::size_t i = 0; i < results.size(); ++i) {
+    const SequenceResult& result = results[i];
+    out << "frame " << i << ", " << result.input << " -> " << result.output << ": "
+        << result.inWidth << "x" << result.inHeight << " -> "
+        << result.outWidth << "x" << result.outHeight
+        << ", guided " << result.guided << " of " << result.seams << " seams";
+    if (result.changed) {
+      out << " (content changed)";
+    }
+    if (result.shift >= 0) {
+      out << ", shift " << result.shift << " px";
+      shift += result.shift;
+      ++shifted;
+    }
+    out << ", carve " << result.carveSecs * 1e3 << " ms" << std::endl;
+
+    guided += result.guided;
+    seams += result.seams;
+  }
+
+  out << results.size() << " frames carved in " << wallSecs << " s: "
+      << (wallSecs > 0 ? results.size() / wallSecs : 0) << " frames/s, "
+      << guided << " of " << seams << " seams guided, mean shift "
+      << (shifted > 0 ? shift / shifted : 0) << " px" << std::endl;
+
+  out.flags(flags);
+  out.precision(precision);
+}
@@ -0,0 +1,67 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef SEQUENCECARVER_HPP
+#define SEQUENCECARVER_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "ImageLoader.hpp"
+
+struct SequenceResult {
+  std::string input;
+  std::string output;
+
+  int inWidth;
+  int inHeight;
+  int outWidth;
+  int outHeight;
+
+  unsigned int seams;
+  unsigned int guided;
+  bool changed;
+
+  double shift;
+  double carveSecs;
+};
+
+class SequenceCarver {
+  unsigned int threads;
+  unsigned int window;
+
+  bool overrideFormat;
+  PgmFormat format;
+
+  std::vector<std::string> inputs;
+  std::vector<std::string> outputs;
+  std::string streamInput;
+  std::string streamOutput;
+public:
+  SequenceCarver(const unsigned int&, const unsigned int&);
+
+  void setFormat(const PgmFormat&);
+
+  void addFrame(const std::string&, const std::string&);
+  void loadList(const std::string&);
+  void setStream(const std::string&, const std::string&);
+
+  bool run(const unsigned int&, const unsigned int&, std::ostream&);
+private:
+  void report(std::ostream&, const std::vector<SequenceResult>&, double) const;
+};
+#endif
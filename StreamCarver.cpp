@@ -0,0 +1,708 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "StreamCarver.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "CarvingTypes.hpp"
+#include "ImageLoader.hpp"
+#include "Kernels.hpp"
+#include "SeamCarver.hpp"
+#include "Util/Profiler.hpp"
+#include "Util/RawFile.hpp"
+
+namespace {
+
+/** A row-major pixel grid held in a file, rather than in memory.
+ */
+struct FileGrid {
+  RawFile* file;
+  std::uint64_t offset;
+  unsigned int width;
+  unsigned int height;
+  // 16 bit PGM samples are stored big endian, scratch
+  // files hold pixels in their native layout
+  bool bigEndian;
+};
+
+/** Swaps the byte order of pixels, if required by a grid's file.
+
+    @param grid
+    The grid the pixels are read from or written to.
+
+    @param data
+    The pixels to swap.
+
+    @param count
+    The number of pixels.
+ */
+template <typename P>
+void swapIfNeeded(const FileGrid& grid, P* data, std::size_t count) {
+  if (sizeof(P) == 2 && grid.bigEndian) {
+    for (std::size_t i = 0; i < count; ++i) {
+      data[i] = static_cast<P>((data[i] >> 8) | (data[i] << 8));
+    }
+  }
+}
+
+/** Reads consecutive rows of a file backed grid.
+
+    @param grid
+    The grid to read from.
+
+    @param first
+    The first row to read.
+
+    @param count
+    The number of rows to read.
+
+    @param out
+    The memory to store the rows in, densely packed.
+ */
+template <typename P>
+void readRows(const FileGrid& grid, unsigned int first, unsigned int count, P* out) {
+  const std::size_t cells = static_cast<std::size_t>(grid.width) * count;
+  grid.file->read(out, cells * sizeof(P),
+                  grid.offset + static_cast<std::uint64_t>(first) * grid.width * sizeof(P));
+  swapIfNeeded(grid, out, cells);
+}
+
+/** Writes consecutive rows of a file backed grid.
+
+    The rows may be byte swapped in place.
+
+    @param grid
+    The grid to write to.
+
+    @param first
+    The first row to write.
+
+    @param count
+    The number of rows to write.
+
+    @param in
+    The rows to write, densely packed.
+ */
+template <typename P>
+void writeRows(const FileGrid& grid, unsigned int first, unsigned int count, P* in) {
+  const std::size_t cells = static_cast<std::size_t>(grid.width) * count;
+  swapIfNeeded(grid, in, cells);
+  grid.file->write(in, cells * sizeof(P),
+                   grid.offset + static_cast<std::uint64_t>(first) * grid.width * sizeof(P));
+}
+
+/** Determines how many rows may be held in memory at once.
+
+    @param budget
+    The number of bytes which may be used.
+
+    @param fixed
+    The number of bytes used regardless of the number of rows.
+
+    @param perRow
+    The number of bytes used by each row.
+
+    @param height
+    The number of rows in the grid.
+
+    @returns the number of rows per strip.
+ */
+unsigned int stripRows(std::size_t budget, std::size_t fixed, std::size_t perRow, unsigned int height) {
+  if (budget < fixed + perRow) {
+    throw std::runtime_error("Memory budget is too small to hold a single row!");
+  }
+  return static_cast<unsigned int>(std::min<std::size_t>(std::max(height, 1u), (budget - fixed) / perRow));
+}
+
+/** Streams a file backed grid through memory, a strip of rows at a time.
+
+    Every row has the column named by the seam file removed, and
+    is then written to the destination, if any. When a direction
+    file is provided the energy and cost of every row is calculated
+    as it passes, using a window of three rows and two cost rows.
+    Rather than keeping the cost grid, the predecessor each cell's
+    cost was derived from is recorded in the direction file, as -1,
+    0, or 1, using the same tie breaking traceSeam does.
+
+    @param src
+    The grid to read.
+
+    @param seam
+    The column of the seam to remove in every row, or nullptr.
+
+    @param dst
+    The grid to write the compacted rows to, or nullptr.
+
+    @param dirs
+    The file to record the predecessors of every cell in, or nullptr.
+
+    @param mode
+    The carving mode whose tie breaking is followed.
+
+    @param budget
+    The number of bytes which may be used.
+
+    @returns the column of the cheapest cell of the last row, when
+    a direction file is provided.
+ */
+template <typename P, typename E, typename C>
+unsigned int streamPass(const FileGrid& src, RawFile* seam, const FileGrid* dst, RawFile* dirs,
+                        const CarvingMode& mode, std::size_t budget) {
+  const unsigned int inWidth = src.width;
+  const unsigned int width = inWidth - (seam ? 1 : 0);
+  const unsigned int height = src.height;
+
+  const std::size_t fixed = dirs ? width * (3 * sizeof(P) + sizeof(E) + 2 * sizeof(C)) : 0;
+  const std::size_t perRow = inWidth * sizeof(P) + (dirs ? width : 0) + (seam ? sizeof(std::uint32_t) : 0);
+  const unsigned int rows = stripRows(budget, fixed, perRow, height);
+
+  std::vector<P> strip(static_cast<std::size_t>(inWidth) * rows);
+  std::vector<std::uint32_t> seamRows(seam ? rows : 0);
+
+  // The three most recent rows, energy, and the two most recent cost rows
+  std::vector<P> window(dirs ? 3 * width : 0);
+  std::vector<E> energy(dirs ? width : 0);
+  std::vector<C> costA(dirs ? width : 0);
+  std::vector<C> costB(dirs ? width : 0);
+  C* prev = costA.data();
+  C* cur = costB.data();
+
+  std::vector<signed char> dirStrip(dirs ? static_cast<std::size_t>(width) * rows : 0);
+  unsigned int dirFirst = 0;
+
+  auto slot = [&](unsigned int h) { return window.data() + (h % 3) * width; };
+
+  // Calculates the energy, cost, and predecessors of a row,
+  // once the row below it is available
+  auto process = [&](unsigned int h) {
+    const P* up = slot(h > 0 ? h - 1 : h);
+    const P* mid = slot(h);
+    const P* down = slot(h + 1 < height ? h + 1 : h);
+    energyRow(up, mid, down, energy.data(), width);
+
+    signed char* dir = dirStrip.data() + static_cast<std::size_t>(h - dirFirst) * width;
+    if (h == 0) {
+      std::copy(energy.begin(), energy.end(), cur);
+      std::fill(dir, dir + width, 0);
+    } else {
+      costRow(energy.data(), prev, cur, width, true, true);
+      for (unsigned int w = 0; w < width; ++w) {
+        const C minVal = cur[w] - energy[w];
+        if (w > 0 && prev[w - 1] == minVal) {
+          dir[w] = -1;
+        } else if (mode == CarvingMode::VERTICAL) {
+          dir[w] = prev[w] == minVal ? 0 : 1;
+        } else {
+          dir[w] = w + 1 < width && prev[w + 1] == minVal ? 1 : 0;
+        }
+      }
+    }
+    std::swap(prev, cur);
+
+    // Spill the predecessors once the strip is full
+    if (h + 1 - dirFirst == rows || h + 1 == height) {
+      dirs->write(dirStrip.data(), static_cast<std::size_t>(h + 1 - dirFirst) * width,
+                  static_cast<std::uint64_t>(dirFirst) * width);
+      dirFirst = h + 1;
+    }
+  };
+
+  for (unsigned int first = 0; first < height; first += rows) {
+    const unsigned int count = std::min(rows, height - first);
+    {
+      ProfileScope scope(Phase::LOAD, static_cast<std::size_t>(inWidth) * count * sizeof(P));
+      readRows(src, first, count, strip.data());
+      if (seam) {
+        seam->read(seamRows.data(), count * sizeof(std::uint32_t),
+                   static_cast<std::uint64_t>(first) * sizeof(std::uint32_t));
+      }
+    }
+
+    if (seam) {
+      // Compact the strip in place, packing rows densely
+      // at the narrower width
+      ProfileScope scope(Phase::REMOVAL, static_cast<std::size_t>(inWidth) * count * sizeof(P));
+      for (unsigned int i = 0; i < count; ++i) {
+        const P* in = strip.data() + static_cast<std::size_t>(i) * inWidth;
+        P* out = strip.data() + static_cast<std::size_t>(i) * width;
+        const unsigned int s = seamRows[i];
+        std::memmove(out, in, s * sizeof(P));
+        std::memmove(out + s, in + s + 1, (inWidth - s - 1) * sizeof(P));
+      }
+    }
+
+    if (dirs) {
+      // Energy is calculated along with the cost of every row
+      ProfileScope scope(Phase::COST, static_cast<std::size_t>(width) * count *
+                                      (sizeof(P) + sizeof(E) + sizeof(C) + 1));
+      for (unsigned int i = 0; i < count; ++i) {
+        const P* out = strip.data() + static_cast<std::size_t>(i) * width;
+        const unsigned int h = first + i;
+        std::copy(out, out + width, slot(h));
+        if (h > 0) {
+          process(h - 1);
+        }
+      }
+    }
+
+    if (dst) {
+      ProfileScope scope(Phase::EXPORT, static_cast<std::size_t>(width) * count * sizeof(P));
+      writeRows(*dst, first, count, strip.data());
+    }
+  }
+
+  if (!dirs) {
+    return 0;
+  }
+  ProfileScope scope(Phase::COST, static_cast<std::size_t>(width) * (sizeof(P) + sizeof(E) + sizeof(C) + 1));
+  process(height - 1);
+
+  // Locate the cheapest cell of the last row, which
+  // now resides in the previous cost row
+  unsigned int next = 0;
+  if (mode == CarvingMode::VERTICAL) {
+    for (unsigned int w = width - 1; w + 1 > 0; --w) {
+      if (prev[w] < prev[next]) {
+        next = w;
+      }
+    }
+  } else {
+    for (unsigned int w = 0; w < width; ++w) {
+      if (prev[w] < prev[next]) {
+        next = w;
+      }
+    }
+  }
+  return next;
+}
+
+/** Traces a seam through a direction file, from the bottom row up.
+
+    @param dirs
+    The predecessors of every cell, recorded by streamPass.
+
+    @param width
+    The number of cells in every row.
+
+    @param height
+    The number of rows.
+
+    @param start
+    The column of the seam in the last row.
+
+    @param seam
+    The file to store the column of the seam in every row in.
+
+    @param budget
+    The number of bytes which may be used.
+ */
+void traceStream(RawFile& dirs, unsigned int width, unsigned int height, unsigned int start,
+                 RawFile& seam, std::size_t budget) {
+  ProfileScope scope(Phase::TRACEBACK, static_cast<std::size_t>(width) * height + height * sizeof(std::uint32_t));
+  const unsigned int rows = stripRows(budget, 0, width + sizeof(std::uint32_t), height);
+  std::vector<signed char> dirStrip(static_cast<std::size_t>(width) * rows);
+  std::vector<std::uint32_t> seamRows(rows);
+
+  unsigned int next = start;
+  for (unsigned int end = height; end > 0;) {
+    const unsigned int first = end > rows ? end - rows : 0;
+    const unsigned int count = end - first;
+    dirs.read(dirStrip.data(), static_cast<std::size_t>(count) * width,
+              static_cast<std::uint64_t>(first) * width);
+
+    // The first row records no predecessors, so the seam stays put
+    for (unsigned int h = end; h > first; --h) {
+      seamRows[h - 1 - first] = next;
+      next += dirStrip[static_cast<std::size_t>(h - 1 - first) * width + next];
+    }
+
+    seam.write(seamRows.data(), count * sizeof(std::uint32_t),
+               static_cast<std::uint64_t>(first) * sizeof(std::uint32_t));
+    end = first;
+  }
+}
+
+/** Transposes a file backed grid into another.
+
+    Strips of rows are transposed in memory. When a strip
+    holds every row, or its columns make long enough runs
+    of the destination rows, they are written directly.
+    Otherwise each strip is spilled to a scratch file as a
+    single block, then bands of destination rows are gathered
+    from every block, so that each band is written at once,
+    rather than writing a short run per column of every strip.
+
+    @param src
+    The grid to read.
+
+    @param dst
+    The grid to write, with the deminsions of src swapped.
+
+    @param budget
+    The number of bytes which may be used.
+
+    @param tmpDir
+    The directory scratch files are created in.
+ */
+template <typename P>
+void transposeStream(const FileGrid& src, const FileGrid& dst, std::size_t budget, const std::string& tmpDir) {
+  // Runs of at least this many bytes are written directly
+  const std::size_t RUN_BYTES = 64 * 1024;
+
+  const unsigned int rows = stripRows(budget, 0, 2 * src.width * sizeof(P), src.height);
+  const bool direct = rows == src.height || rows * sizeof(P) >= RUN_BYTES;
+  std::vector<P> strip(static_cast<std::size_t>(src.width) * rows);
+  std::vector<P> turned(strip.size());
+  std::unique_ptr<RawFile> blocks(direct ? nullptr : new RawFile(tmpDir, FileAccess::TEMPORARY));
+
+  for (unsigned int first = 0; first < src.height; first += rows) {
+    const unsigned int count = std::min(rows, src.height - first);
+    {
+      ProfileScope scope(Phase::LOAD, static_cast<std::size_t>(src.width) * count * sizeof(P));
+      readRows(src, first, count, strip.data());
+    }
+
+    ProfileScope scope(Phase::EXPORT, static_cast<std::size_t>(src.width) * count * sizeof(P));
+    for (unsigned int i = 0; i < count; ++i) {
+      const P* in = strip.data() + static_cast<std::size_t>(i) * src.width;
+      for (unsigned int w = 0; w < src.width; ++w) {
+        turned[static_cast<std::size_t>(w) * count + i] = in[w];
+      }
+    }
+
+    if (!direct) {
+      // Blocks are stored in the order of their strips
+      blocks->write(turned.data(), static_cast<std::size_t>(src.width) * count * sizeof(P),
+                    static_cast<std::uint64_t>(first) * src.width * sizeof(P));
+      continue;
+    }
+    swapIfNeeded(dst, turned.data(), static_cast<std::size_t>(src.width) * count);
+    if (count == src.height) {
+      dst.file->write(turned.data(), turned.size() * sizeof(P), dst.offset);
+      continue;
+    }
+    for (unsigned int w = 0; w < src.width; ++w) {
+      dst.file->write(turned.data() + static_cast<std::size_t>(w) * count, count * sizeof(P),
+                      dst.offset + (static_cast<std::uint64_t>(w) * dst.width + first) * sizeof(P));
+    }
+  }
+  if (direct) {
+    return;
+  }
+
+  // Every block holds a run of each destination row, with
+  // the runs of consecutive destination rows stored together
+  const unsigned int band = stripRows(budget, 0, 2 * dst.width * sizeof(P), dst.height);
+  std::vector<P> rowBand(static_cast<std::size_t>(dst.width) * band);
+  std::vector<P> block(static_cast<std::size_t>(rows) * band);
+  for (unsigned int top = 0; top < dst.height; top += band) {
+    const unsigned int count = std::min(band, dst.height - top);
+    for (unsigned int first = 0; first < src.height; first += rows) {
+      const unsigned int runs = std::min(rows, src.height - first);
+      ProfileScope scope(Phase::LOAD, static_cast<std::size_t>(runs) * count * sizeof(P));
+      blocks->read(block.data(), static_cast<std::size_t>(runs) * count * sizeof(P),
+                   (static_cast<std::uint64_t>(first) * src.width + static_cast<std::uint64_t>(top) * runs) *
+                   sizeof(P));
+      for (unsigned int j = 0; j < count; ++j) {
+        std::copy(block.data() + static_cast<std::size_t>(j) * runs,
+                  block.data() + static_cast<std::size_t>(j + 1) * runs,
+                  rowBand.data() + static_cast<std::size_t>(j) * dst.width + first);
+      }
+    }
+
+    ProfileScope scope(Phase::EXPORT, static_cast<std::size_t>(dst.width) * count * sizeof(P));
+    writeRows(dst, top, count, rowBand.data());
+  }
+}
+
+/** Removes seams from a file backed grid.
+
+    Every seam requires one pass over the grid, which removes
+    the previous seam while calculating the cost of the next,
+    followed by a backwards pass over the recorded predecessors.
+    A final pass removes the last seam while writing the result.
+    Only the spilled scratch files grow with the image, memory
+    is bounded by the budget.
+
+    @param src
+    The grid to read.
+
+    @param dst
+    The grid to write, narrowed by amt columns.
+
+    @param amt
+    The amt of seams to remove.
+
+    @param mode
+    The carving mode whose tie breaking is followed.
+
+    @param budget
+    The number of bytes which may be used.
+
+    @param tmpDir
+    The directory scratch files are created in.
+ */
+template <typename P, typename E, typename C>
+void carveStream(const FileGrid& src, const FileGrid& dst, unsigned int amt, const CarvingMode& mode,
+                 std::size_t budget, const std::string& tmpDir) {
+  if (amt == 0) {
+    streamPass<P, E, C>(src, nullptr, &dst, nullptr, mode, budget);
+    return;
+  }
+  if (amt > src.width || src.height < 1) {
+    throw std::runtime_error("No seams left to remove!");
+  }
+
+  RawFile scratchA(tmpDir, FileAccess::TEMPORARY);
+  RawFile scratchB(tmpDir, FileAccess::TEMPORARY);
+  RawFile dirs(tmpDir, FileAccess::TEMPORARY);
+  RawFile seam(tmpDir, FileAccess::TEMPORARY);
+
+  // The first pass only reads the source, every following pass
+  // writes a compacted copy to the scratch file not being read
+  FileGrid cur = src;
+  for (unsigned int i = 0; i < amt; ++i) {
+    // Each pass finds a seam while removing the one before it
+    ProfileScope seamScope(Phase::SEAM, 0, i);
+    FileGrid next = cur;
+    if (i > 0) {
+      next.file = cur.file == &scratchA ? &scratchB : &scratchA;
+      next.offset = 0;
+      next.width = cur.width - 1;
+      next.bigEndian = false;
+    }
+    const unsigned int start = streamPass<P, E, C>(cur, i > 0 ? &seam : nullptr, i > 0 ? &next : nullptr,
+                                                   &dirs, mode, budget);
+    traceStream(dirs, next.width, next.height, start, seam, budget);
+    cur = next;
+  }
+  streamPass<P, E, C>(cur, &seam, &dst, nullptr, mode, budget);
+}
+
+/** Removes seams from a file backed grid, picking the narrowest safe cost type.
+
+    @param src
+    The grid to read.
+
+    @param dst
+    The grid to write, narrowed by amt columns.
+
+    @param amt
+    The amt of seams to remove.
+
+    @param mode
+    The carving mode whose tie breaking is followed.
+
+    @param budget
+    The number of bytes which may be used.
+
+    @param tmpDir
+    The directory scratch files are created in.
+ */
+template <typename P>
+void carveStreamAny(const FileGrid& src, const FileGrid& dst, unsigned int amt, const CarvingMode& mode,
+                    std::size_t budget, const std::string& tmpDir) {
+  typedef typename EnergyOf<P>::type E;
+  typedef typename CostOf<E>::type C;
+
+  if (needsWideCost<P>(src.height)) {
+    carveStream<P, E, typename WideCostOf<C>::type>(src, dst, amt, mode, budget, tmpDir);
+  } else {
+    carveStream<P, E, C>(src, dst, amt, mode, budget, tmpDir);
+  }
+}
+
+}
+
+/** Construct a new StreamCarver object.
+
+    @param budget
+    The number of bytes carving may use, not counting
+    the (fixed) size of the program itself.
+
+    @param tmpDir
+    The directory scratch files are created in.
+
+    @param pool
+    The thread pool to split calculations across, when
+    the image fits within the budget.
+
+    @param batch
+    The maximum number of seams to remove per cost grid, when
+    the image fits within the budget.
+ */
+StreamCarver::StreamCarver(const std::size_t& budget, const std::string& tmpDir, ThreadPool& pool,
+                           const unsigned int& batch) :
+  budget(budget), tmpDir(tmpDir), pool(pool), batch(batch) { }
+
+/** Checks whether an image may be carved in memory within the budget.
+
+    @param width
+    The number of columns of the image.
+
+    @param height
+    The number of rows of the image.
+
+    @param wide
+    Whether pixels are stored in 16 bits.
+
+    @returns true if the image, its copies, and its
+    energy and cost grids fit within the budget.
+ */
+bool StreamCarver::fitsInMemory(const unsigned int& width, const unsigned int& height, const bool& wide) const {
+  // The loaded image, the engine's pixel grids, the result, and
+  // the energy and cost grids are all alive at once
+  const std::size_t cellSize = wide ?
+    5 * sizeof(std::uint16_t) + sizeof(EnergyOf<std::uint16_t>::type) + 2 * sizeof(std::uint64_t) :
+    5 * sizeof(std::uint8_t) + sizeof(EnergyOf<std::uint8_t>::type) + 2 * sizeof(std::uint32_t);
+  return static_cast<double>(width) * height * cellSize <= budget;
+}
+
+/** Removes seams from a binary (P5) PGM file.
+
+    Images which fit within the budget are carved in memory.
+    Larger images are streamed through memory a strip of rows
+    at a time, spilling intermediate results to scratch files,
+    so that memory use is bounded by the budget rather than
+    the size of the image. Both produce identical results to
+    carving with a batch size of 1.
+
+    Horizontal seams are removed by transposing the image
+    on disk, removing vertical seams, then transposing the
+    result back.
+
+    @param input
+    The PGM file to carve.
+
+    @param output
+    The PGM file to write the carved image to.
+
+    @param vert
+    The number of vertical seams to remove.
+
+    @param horiz
+    The number of horizontal seams to remove.
+ */
+void StreamCarver::carveFile(const std::string& input, const std::string& output, const unsigned int& vert,
+                             const unsigned int& horiz) const {
+  ImageLoader loader;
+  loader.loadHeader(input);
+  if (loader.getFormat() != PgmFormat::BINARY) {
+    throw std::runtime_error("Only binary (P5) PGM files may be streamed!");
+  }
+
+  const bool inMemory = fitsInMemory(loader.getWidth(), loader.getHeight(), loader.isWide());
+  if (loader.isWide()) {
+    if (inMemory) {
+      carveInMemory<std::uint16_t>(input, output, vert, horiz);
+    } else {
+      carveStreamed<std::uint16_t>(input, output, vert, horiz);
+    }
+  } else {
+    if (inMemory) {
+      carveInMemory<std::uint8_t>(input, output, vert, horiz);
+    } else {
+      carveStreamed<std::uint8_t>(input, output, vert, horiz);
+    }
+  }
+}
+
+/** Removes seams from a PGM file held entirely in memory.
+
+    @param input
+    The PGM file to carve.
+
+    @param output
+    The PGM file to write the carved image to.
+
+    @param vert
+    The number of vertical seams to remove.
+
+    @param horiz
+    The number of horizontal seams to remove.
+ */
+template <typename P>
+  void StreamCarver::carveInMemory(const std::string& input, const std::string& output,
+                                   const unsigned int& vert, const unsigned int& horiz) const {
+    ImageLoader loader;
+    loader.loadFile(input);
+    FlexGrid<P> f = seamCarve(loader.getGrid<P>(), CarvingMode::VERTICAL, vert, pool, batch);
+    loader.setGrid(seamCarve(f, CarvingMode::HORIZONTAL, horiz, pool, batch));
+    loader.exportFile(output);
+  }
+
+/** Removes seams from a PGM file streamed through memory.
+
+    @param input
+    The PGM file to carve.
+
+    @param output
+    The PGM file to write the carved image to.
+
+    @param vert
+    The number of vertical seams to remove.
+
+    @param horiz
+    The number of horizontal seams to remove.
+ */
+template <typename P>
+  void StreamCarver::carveStreamed(const std::string& input, const std::string& output,
+                                   const unsigned int& vert, const unsigned int& horiz) const {
+    ImageLoader loader;
+    const std::size_t bodyOffset = loader.loadHeader(input);
+    const unsigned int width = loader.getWidth();
+    const unsigned int height = loader.getHeight();
+    if (vert > width || horiz > height) {
+      throw std::runtime_error("No seams left to remove!");
+    }
+
+    // Write the header the same way ImageLoader exports it
+    const std::string header = "P5\n# " + output + "\n" + std::to_string(width - vert) + " " +
+                               std::to_string(height - horiz) + "\n" +
+                               std::to_string(loader.getGreyScale()) + "\n";
+    RawFile in(input, FileAccess::READ);
+    RawFile out(output, FileAccess::WRITE);
+    out.write(header.data(), header.size(), 0);
+
+    const FileGrid source = {&in, bodyOffset, width, height, true};
+    const FileGrid result = {&out, header.size(), width - vert, height - horiz, true};
+    if (horiz == 0) {
+      carveStreamAny<P>(source, result, vert, CarvingMode::VERTICAL, budget, tmpDir);
+      return;
+    }
+
+    // Remove the vertical seams, then carve the transposed
+    // image, as the engine does for horizontal seams
+    RawFile carved(tmpDir, FileAccess::TEMPORARY);
+    RawFile turned(tmpDir, FileAccess::TEMPORARY);
+    FileGrid narrowed = source;
+    if (vert > 0) {
+      narrowed = {&carved, 0, width - vert, height, false};
+      carveStreamAny<P>(source, narrowed, vert, CarvingMode::VERTICAL, budget, tmpDir);
+    }
+
+    const FileGrid across = {&turned, 0, height, width - vert, false};
+    transposeStream<P>(narrowed, across, budget, tmpDir);
+
+    const FileGrid shortened = {&carved, 0, height - horiz, width - vert, false};
+    carveStreamAny<P>(across, shortened, horiz, CarvingMode::HORIZONTAL, budget, tmpDir);
+    transposeStream<P>(shortened, result, budget, tmpDir);
+  }
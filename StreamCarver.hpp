@@ -0,0 +1,43 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef STREAMCARVER_HPP
+#define STREAMCARVER_HPP
+
+#include <cstddef>
+#include <string>
+
+#include "Util/ThreadPool.hpp"
+
+class StreamCarver {
+  std::size_t budget;
+  std::string tmpDir;
+  ThreadPool& pool;
+  unsigned int batch;
+public:
+  StreamCarver(const std::size_t&, const std::string&, ThreadPool&, const unsigned int&);
+
+  bool fitsInMemory(const unsigned int&, const unsigned int&, const bool&) const;
+
+  void carveFile(const std::string&, const std::string&, const unsigned int&, const unsigned int&) const;
+private:
+  template <typename P>
+    void carveInMemory(const std::string&, const std::string&, const unsigned int&,
+                       const unsigned int&) const;
+  template <typename P>
+    void carveStreamed(const std::string&, const std::string&, const unsigned int&,
+                       const unsigned int&) const;
+};
+#endif
@@ -0,0 +1,49 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef ALIGNEDBUFFER_HPP
+#define ALIGNEDBUFFER_HPP
+
+#include <cstddef>
+
+template <typename T>
+class AlignedBuffer {
+  unsigned char* raw;
+  T* data;
+  std::size_t size;
+public:
+  static const std::size_t ALIGNMENT = 64;
+
+  AlignedBuffer();
+  explicit AlignedBuffer(std::size_t);
+  AlignedBuffer(const AlignedBuffer&);
+  AlignedBuffer(AlignedBuffer&&);
+  ~AlignedBuffer();
+
+  AlignedBuffer& operator = (const AlignedBuffer&);
+  AlignedBuffer& operator = (AlignedBuffer&&);
+
+  T* get();
+  const T* get() const;
+
+  std::size_t len() const;
+private:
+  void allocate(std::size_t);
+  void release();
+};
+
+#include "AlignedBuffer.ipp"
+
+#endif
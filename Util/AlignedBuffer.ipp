@@ -0,0 +1,184 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <algorithm>
+#include <cstdint>
+
+#include "Profiler.hpp"
+
+/** Construct a new AlignedBuffer object.
+
+    Constructs a new AlignedBuffer object, which
+    holds no elements.
+ */
+template <typename T>
+  AlignedBuffer<T>::AlignedBuffer() : raw(nullptr), data(nullptr), size(0) { }
+
+/** Construct a new AlignedBuffer object.
+
+    Constructs a new AlignedBuffer object, holding
+    the requested number of value initialized elements,
+    with the first element aligned to ALIGNMENT bytes.
+
+    @param size
+    The number of elements to allocate.
+ */
+template <typename T>
+  AlignedBuffer<T>::AlignedBuffer(std::size_t size) : raw(nullptr), data(nullptr), size(0) {
+    allocate(size);
+    std::fill(data, data + size, T());
+  }
+
+/** Construct a new AlignedBuffer object.
+
+    Constructs a new AlignedBuffer object, which
+    holds a copy of every element in the provided buffer.
+
+    @param other
+    The buffer to copy.
+ */
+template <typename T>
+  AlignedBuffer<T>::AlignedBuffer(const AlignedBuffer& other) : raw(nullptr), data(nullptr), size(0) {
+    allocate(other.size);
+    std::copy(other.data, other.data + other.size, data);
+  }
+
+/** Construct a new AlignedBuffer object.
+
+    Constructs a new AlignedBuffer object, taking
+    ownership of the provided buffer's memory.
+
+    @param other
+    The buffer to take ownership from.
+ */
+template <typename T>
+  AlignedBuffer<T>::AlignedBuffer(AlignedBuffer&& other) :
+    raw(other.raw), data(other.data), size(other.size) {
+    other.raw = nullptr;
+    other.data = nullptr;
+    other.size = 0;
+  }
+
+/** Destroys the AlignedBuffer object, releasing its memory.
+ */
+template <typename T>
+  AlignedBuffer<T>::~AlignedBuffer() {
+    release();
+  }
+
+/** Replaces the contents of this buffer with a copy of another.
+
+    @param other
+    The buffer to copy.
+
+    @returns this buffer.
+ */
+template <typename T>
+  AlignedBuffer<T>& AlignedBuffer<T>::operator = (const AlignedBuffer& other) {
+    if (this != &other) {
+      // Only reallocate if the sizes differ, so that repeated
+      // assignment between equally sized buffers is cheap
+      if (size != other.size) {
+        release();
+        allocate(other.size);
+      }
+      std::copy(other.data, other.data + other.size, data);
+    }
+    return *this;
+  }
+
+/** Replaces the contents of this buffer with another's memory.
+
+    @param other
+    The buffer to take ownership from.
+
+    @returns this buffer.
+ */
+template <typename T>
+  AlignedBuffer<T>& AlignedBuffer<T>::operator = (AlignedBuffer&& other) {
+    if (this != &other) {
+      release();
+      raw = other.raw;
+      data = other.data;
+      size = other.size;
+      other.raw = nullptr;
+      other.data = nullptr;
+      other.size = 0;
+    }
+    return *this;
+  }
+
+/** Retrieves the first element of the buffer.
+
+    @returns a pointer to the first, aligned, element
+    of the buffer, or nullptr if the buffer is empty.
+ */
+template <typename T>
+  T* AlignedBuffer<T>::get() {
+    return data;
+  }
+
+/** Retrieves the first element of the buffer.
+
+    @returns a pointer to the first, aligned, element
+    of the buffer, or nullptr if the buffer is empty.
+ */
+template <typename T>
+  const T* AlignedBuffer<T>::get() const {
+    return data;
+  }
+
+/** Gets the number of elements held by the buffer.
+
+    @returns the number of elements.
+ */
+template <typename T>
+  std::size_t AlignedBuffer<T>::len() const {
+    return size;
+  }
+
+/** Allocates uninitialized memory for the buffer.
+
+    Over allocates by ALIGNMENT bytes, so that the
+    first element may be shifted onto an aligned address.
+    Every allocation is counted by the Profiler.
+
+    @param size
+    The number of elements to allocate.
+ */
+template <typename T>
+  void AlignedBuffer<T>::allocate(std::size_t size) {
+    this->size = size;
+    if (size == 0) {
+      return;
+    }
+
+    raw = new unsigned char[size * sizeof(T) + ALIGNMENT];
+    Profiler::countAllocation(size * sizeof(T) + ALIGNMENT);
+
+    std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(raw);
+    addr = (addr + ALIGNMENT - 1) & ~static_cast<std::uintptr_t>(ALIGNMENT - 1);
+    data = reinterpret_cast<T*>(addr);
+  }
+
+/** Releases the memory held by the buffer.
+ */
+template <typename T>
+  void AlignedBuffer<T>::release() {
+    delete[] raw;
+    raw = nullptr;
+    data = nullptr;
+    size = 0;
+  }
@@ -0,0 +1,130 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "BufferedWriter.hpp"
+
+#include <cstring>
+#include <stdexcept>
+
+/** Construct a new BufferedWriter object.
+
+    Opens, and truncates, the file at the provided path
+    for writing. Writes are gathered in a large buffer,
+    which is only handed to the file once full.
+
+    @param path
+    The file to write to.
+ */
+BufferedWriter::BufferedWriter(const std::string& path) :
+  file(std::fopen(path.c_str(), "wb")), buffer(1 << 16), used(0) {
+  if (!file) {
+    throw std::runtime_error("Unable to open " + path + " for writing!");
+  }
+}
+
+/** Destroys the BufferedWriter object, flushing and closing the file.
+
+    Errors are silently dropped, call close beforehand
+    to have them reported.
+ */
+BufferedWriter::~BufferedWriter() {
+  if (file) {
+    std::fwrite(buffer.data(), 1, used, file);
+    std::fclose(file);
+  }
+}
+
+/** Writes a single character.
+
+    @param c
+    The character to write.
+ */
+void BufferedWriter::put(char c) {
+  if (used == buffer.size()) {
+    flush();
+  }
+  buffer[used++] = c;
+}
+
+/** Writes a string.
+
+    @param str
+    The string to write.
+ */
+void BufferedWriter::putStr(const std::string& str) {
+  write(str.data(), str.size());
+}
+
+/** Writes an unsigned integer in decimal.
+
+    @param val
+    The integer to write.
+ */
+void BufferedWriter::putUInt(unsigned long val) {
+  // Build the digits from least to most significant
+  char digits[24];
+  char* pos = digits + sizeof(digits);
+  do {
+    *--pos = static_cast<char>('0' + val % 10);
+    val /= 10;
+  } while (val > 0);
+  write(pos, digits + sizeof(digits) - pos);
+}
+
+/** Writes a block of bytes.
+
+    @param data
+    The first byte to write.
+
+    @param len
+    The number of bytes to write.
+ */
+void BufferedWriter::write(const char* data, std::size_t len) {
+  if (used + len > buffer.size()) {
+    flush();
+    // Blocks larger than the buffer skip it entirely
+    if (len > buffer.size()) {
+      if (std::fwrite(data, 1, len, file) != len) {
+        throw std::runtime_error("Unable to write to file!");
+      }
+      return;
+    }
+  }
+  std::memcpy(buffer.data() + used, data, len);
+  used += len;
+}
+
+/** Hands the buffered bytes to the file.
+ */
+void BufferedWriter::flush() {
+  if (used > 0 && std::fwrite(buffer.data(), 1, used, file) != used) {
+    throw std::runtime_error("Unable to write to file!");
+  }
+  used = 0;
+}
+
+/** Flushes and closes the file, reporting any errors.
+ */
+void BufferedWriter::close() {
+  if (!file) {
+    return;
+  }
+  flush();
+  std::FILE* closing = file;
+  file = nullptr;
+  if (std::fclose(closing) != 0) {
+    throw std::runtime_error("Unable to write to file!");
+  }
+}
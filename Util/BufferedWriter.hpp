@@ -0,0 +1,43 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef BUFFEREDWRITER_HPP
+#define BUFFEREDWRITER_HPP
+
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+class BufferedWriter {
+  std::FILE* file;
+  std::vector<char> buffer;
+  std::size_t used;
+public:
+  explicit BufferedWriter(const std::string&);
+  BufferedWriter(const BufferedWriter&) = delete;
+  ~BufferedWriter();
+
+  BufferedWriter& operator = (const BufferedWriter&) = delete;
+
+  void put(char);
+  void putStr(const std::string&);
+  void putUInt(unsigned long);
+  void write(const char*, std::size_t);
+
+  void flush();
+  void close();
+};
+#endif
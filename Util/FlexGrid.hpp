@@ -16,27 +16,53 @@
 #ifndef FLEXGRID_HPP
 #define FLEXGRID_HPP
 
-#include <vector>
+#include "AlignedBuffer.hpp"
+#include "StridedView.hpp"
 
 template <typename T>
 class FlexGrid {
   unsigned int width;
   unsigned int height;
-  std::vector<std::vector<T>> grid;
+  unsigned int stride;
+  AlignedBuffer<T> grid;
 public:
   FlexGrid(unsigned int, unsigned int);
 
   T getValAt(unsigned int, unsigned int) const;
   void setValAt(const unsigned int&, const unsigned int&, const T&);
 
+  T& operator () (unsigned int, unsigned int);
+  const T& operator () (unsigned int, unsigned int) const;
+
+  T* row(unsigned int);
+  const T* row(unsigned int) const;
+
+  StridedView<T> getRow(unsigned int);
+  StridedView<const T> getRow(unsigned int) const;
+  StridedView<T> getCol(unsigned int);
+  StridedView<const T> getCol(unsigned int) const;
+
   void setWidth(const unsigned int&);
   void setHeight(const unsigned int&);
+  void reshape(const unsigned int&, const unsigned int&);
+  void assign(const FlexGrid&);
 
   unsigned int len() const;
   unsigned int getWidth() const;
   unsigned int getHeight() const;
+  unsigned int getStride() const;
+private:
+  static unsigned int calcStride(unsigned int);
+  void reallocate(unsigned int, unsigned int);
 };
 
+template <typename K>
+  FlexGrid<K> transpose(const FlexGrid<K>&);
+template <typename K>
+  void transposeInto(const FlexGrid<K>&, FlexGrid<K>&);
+template <typename K, typename F>
+  FlexGrid<K> convertGrid(const FlexGrid<F>&);
+
 #include "FlexGrid.ipp"
 
 #endif
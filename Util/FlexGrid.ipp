@@ -13,10 +13,16 @@
 // You should have received a copy of the GNU General Public License
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <cassert>
 #include <stdexcept>
 
 /** Construct a new FlexGrid object.
 
+    The grid is stored row by row in a single aligned
+    buffer, with each row padded out to the grid's stride
+    so that every row begins on an aligned address.
+
     @param width
     The width of the grid
 
@@ -25,12 +31,8 @@
  */
 template <typename T>
   FlexGrid<T>::FlexGrid(unsigned int width, unsigned int height) :
-    width(width), height(height) {
-    grid.resize(width);
-    for (auto& entry : grid) {
-      entry.resize(height);
-    }
-  }
+    width(width), height(height), stride(calcStride(width)),
+    grid(static_cast<std::size_t>(stride) * height) { }
 
 /** Retrieves the value at the given 2D quards.
 
@@ -48,14 +50,14 @@ template <typename T>
  */
 template <typename T>
   T FlexGrid<T>::getValAt(unsigned int x, unsigned int y) const {
-    if (x >= width || x < 0) {
+    if (x >= width) {
       throw std::runtime_error("Given x is not within bounds!");
     }
-    if (y >= height || y < 0) {
+    if (y >= height) {
       throw std::runtime_error("Given y is not within bounds!");
     }
 
-    return grid[x][y];
+    return (*this)(x, y);
   }
 
 /** Sets the value at the given 2D quards.
@@ -75,14 +77,136 @@ template <typename T>
  */
 template <typename T>
   void FlexGrid<T>::setValAt(const unsigned int& x, const unsigned int& y, const T& val) {
-    if (x >= width || x < 0) {
+    if (x >= width) {
       throw std::runtime_error("Given x is not within bounds!");
     }
-    if (y >= height || y < 0) {
+    if (y >= height) {
       throw std::runtime_error("Given y is not within bounds!");
     }
 
-    grid[x][y] = val;
+    (*this)(x, y) = val;
+  }
+
+/** Accesses the value at the given 2D quards.
+
+    Unlike getValAt and setValAt, the quards are only
+    bounds checked in debug builds, making this the
+    accessor of choice for hot loops.
+
+    @param x
+    The x quardinate.
+
+    @param y
+    The y quardinate.
+
+    @return a reference to the value held by the grid.
+ */
+template <typename T>
+  T& FlexGrid<T>::operator () (unsigned int x, unsigned int y) {
+    assert(x < width && y < height);
+    return grid.get()[static_cast<std::size_t>(y) * stride + x];
+  }
+
+/** Accesses the value at the given 2D quards.
+
+    Unlike getValAt, the quards are only bounds checked
+    in debug builds, making this the accessor of choice
+    for hot loops.
+
+    @param x
+    The x quardinate.
+
+    @param y
+    The y quardinate.
+
+    @return a reference to the value held by the grid.
+ */
+template <typename T>
+  const T& FlexGrid<T>::operator () (unsigned int x, unsigned int y) const {
+    assert(x < width && y < height);
+    return grid.get()[static_cast<std::size_t>(y) * stride + x];
+  }
+
+/** Retrieves the first element of a row.
+
+    The elements of a row are contiguous, and the
+    first element of every row is aligned.
+
+    @param y
+    The y quardinate of the row.
+
+    @returns a pointer to the first element of the row.
+ */
+template <typename T>
+  T* FlexGrid<T>::row(unsigned int y) {
+    assert(y < height);
+    return grid.get() + static_cast<std::size_t>(y) * stride;
+  }
+
+/** Retrieves the first element of a row.
+
+    The elements of a row are contiguous, and the
+    first element of every row is aligned.
+
+    @param y
+    The y quardinate of the row.
+
+    @returns a pointer to the first element of the row.
+ */
+template <typename T>
+  const T* FlexGrid<T>::row(unsigned int y) const {
+    assert(y < height);
+    return grid.get() + static_cast<std::size_t>(y) * stride;
+  }
+
+/** Retrieves a view of a row.
+
+    @param y
+    The y quardinate of the row.
+
+    @returns a view over the width elements of the row.
+ */
+template <typename T>
+  StridedView<T> FlexGrid<T>::getRow(unsigned int y) {
+    return StridedView<T>(row(y), width, 1);
+  }
+
+/** Retrieves a view of a row.
+
+    @param y
+    The y quardinate of the row.
+
+    @returns a view over the width elements of the row.
+ */
+template <typename T>
+  StridedView<const T> FlexGrid<T>::getRow(unsigned int y) const {
+    return StridedView<const T>(row(y), width, 1);
+  }
+
+/** Retrieves a view of a column.
+
+    @param x
+    The x quardinate of the column.
+
+    @returns a view over the height elements of the column.
+ */
+template <typename T>
+  StridedView<T> FlexGrid<T>::getCol(unsigned int x) {
+    assert(x < width);
+    return StridedView<T>(grid.get() + x, height, stride);
+  }
+
+/** Retrieves a view of a column.
+
+    @param x
+    The x quardinate of the column.
+
+    @returns a view over the height elements of the column.
+ */
+template <typename T>
+  StridedView<const T> FlexGrid<T>::getCol(unsigned int x) const {
+    assert(x < width);
+    return StridedView<const T>(grid.get() + x, height, stride);
   }
 
 /** Sets the grid width.
@@ -90,17 +214,24 @@ template <typename T>
     Takes a new width value, and adds or removes
     adequate columns. Deleted columns are not removed
     from memory, but are instead made inaccessible
-    for performance reasons.
+    for performance reasons. The grid is only reallocated
+    when it grows past its stride.
 
     @param width
     The width of the grid, or x length.
  */
 template <typename T>
   void FlexGrid<T>::setWidth(const unsigned int& width) {
+    if (width > stride) {
+      reallocate(width, height);
+      return;
+    }
+    // Clear any columns which are being made accessible
+    // again, so that they appear freshly added
+    for (unsigned int y = 0; y < height; ++y) {
+      std::fill(row(y) + std::min(this->width, width), row(y) + width, T());
+    }
     this->width = width;
-    // Resize the row/x vector, adding new vectors
-    // with the proper height where necessary
-    grid.resize(width, std::vector<T>(height));
   }
 
 /** Sets the grid height.
@@ -108,27 +239,76 @@ template <typename T>
     Takes a new height value, and adds or removes
     adequate rows. Deleted rows are not removed
     from memory, but are instead made inaccessible
-    for performance reasons.
+    for performance reasons. The grid is only reallocated
+    when it grows past its allocated row count.
 
     @param width
     The height of the grid, or y length.
  */
 template <typename T>
   void FlexGrid<T>::setHeight(const unsigned int& height) {
+    if (stride == 0 || static_cast<std::size_t>(height) * stride > grid.len()) {
+      reallocate(width, height);
+      return;
+    }
+    // Clear any rows which are being made accessible
+    // again, so that they appear freshly added
+    for (unsigned int y = this->height; y < height; ++y) {
+      std::fill(grid.get() + static_cast<std::size_t>(y) * stride,
+                grid.get() + static_cast<std::size_t>(y) * stride + width, T());
+    }
+    this->height = height;
+  }
+
+/** Changes both deminsions of the grid, discarding its values.
+
+    Reuses the grid's memory whenever it is large enough,
+    making this suitable for scratch grids which are
+    refilled for images of varying sizes. The values of
+    the grid are unspecified afterwards.
+
+    @param width
+    The new width of the grid.
+
+    @param height
+    The new height of the grid.
+ */
+template <typename T>
+  void FlexGrid<T>::reshape(const unsigned int& width, const unsigned int& height) {
+    const unsigned int newStride = calcStride(width);
+    if (static_cast<std::size_t>(newStride) * height > grid.len()) {
+      grid = AlignedBuffer<T>(static_cast<std::size_t>(newStride) * height);
+    }
+    this->width = width;
     this->height = height;
-    // Update all column heights to add or remove
-    // rows
-    for (auto& entry : grid) {
-      entry.resize(height);
+    this->stride = newStride;
+  }
+
+/** Replaces the grid's values with a copy of another grid's.
+
+    Unlike copy assignment, reuses the grid's memory
+    whenever it is large enough.
+
+    @param other
+    The grid to copy.
+ */
+template <typename T>
+  void FlexGrid<T>::assign(const FlexGrid& other) {
+    if (this == &other) {
+      return;
+    }
+    reshape(other.width, other.height);
+    for (unsigned int y = 0; y < height; ++y) {
+      std::copy(other.row(y), other.row(y) + width, row(y));
     }
   }
 
 /** Gets the length of the grid.
 
-    Gets the length of the interal 1D representation
-    of the grid.
+    Gets the number of accessible elements in the
+    grid, excluding any row padding.
 
-    @returns the length of the 1D representation.
+    @returns the number of accessible elements.
  */
 template <typename T>
   unsigned int FlexGrid<T>::len() const {
@@ -158,3 +338,124 @@ template <typename T>
   unsigned int FlexGrid<T>::getHeight() const {
     return height;
   }
+
+/** Gets the distance between the start of adjacent rows.
+
+    @returns the row stride, in elements.
+ */
+template <typename T>
+  unsigned int FlexGrid<T>::getStride() const {
+    return stride;
+  }
+
+/** Calculates the row stride for a given width.
+
+    Rounds the width up so that every row spans a whole
+    number of alignment blocks.
+
+    @param width
+    The width of the grid.
+
+    @returns the row stride, in elements.
+ */
+template <typename T>
+  unsigned int FlexGrid<T>::calcStride(unsigned int width) {
+    const unsigned int block = AlignedBuffer<T>::ALIGNMENT % sizeof(T) == 0
+      ? AlignedBuffer<T>::ALIGNMENT / sizeof(T) : 1;
+    return (width + block - 1) / block * block;
+  }
+
+/** Moves the grid into a newly allocated buffer.
+
+    Retains all values which are accessible both
+    before and after the resize, any new cells are
+    value initialized.
+
+    @param width
+    The new width of the grid.
+
+    @param height
+    The new height of the grid.
+ */
+template <typename T>
+  void FlexGrid<T>::reallocate(unsigned int width, unsigned int height) {
+    FlexGrid<T> r(width, height);
+    const unsigned int keepW = std::min(width, this->width);
+    const unsigned int keepH = std::min(height, this->height);
+    for (unsigned int y = 0; y < keepH; ++y) {
+      std::copy(row(y), row(y) + keepW, r.row(y));
+    }
+    *this = std::move(r);
+  }
+
+/** Creates a transposed copy of a grid.
+
+    @param grid
+    The grid to transpose.
+
+    @returns a grid whose rows are the columns of the
+    provided grid.
+ */
+template <typename K>
+  FlexGrid<K> transpose(const FlexGrid<K>& grid) {
+    FlexGrid<K> r(grid.getHeight(), grid.getWidth());
+    transposeInto(grid, r);
+    return r;
+  }
+
+/** Transposes a grid into an existing grid.
+
+    The copy is performed in small square tiles, so that
+    both the rows being read and the rows being written
+    stay resident in cache. Reuses the destination grid's
+    memory whenever it is large enough.
+
+    @param grid
+    The grid to transpose.
+
+    @param r
+    The grid to store the transposed copy in, which
+    must not be the grid being transposed.
+ */
+template <typename K>
+  void transposeInto(const FlexGrid<K>& grid, FlexGrid<K>& r) {
+    const unsigned int TILE = 32;
+
+    r.reshape(grid.getHeight(), grid.getWidth());
+    for (unsigned int ty = 0; ty < grid.getHeight(); ty += TILE) {
+      const unsigned int yEnd = std::min(ty + TILE, grid.getHeight());
+      for (unsigned int tx = 0; tx < grid.getWidth(); tx += TILE) {
+        const unsigned int xEnd = std::min(tx + TILE, grid.getWidth());
+        for (unsigned int y = ty; y < yEnd; ++y) {
+          const K* in = grid.row(y);
+          for (unsigned int x = tx; x < xEnd; ++x) {
+            r(y, x) = in[x];
+          }
+        }
+      }
+    }
+  }
+
+/** Creates a copy of a grid holding another value type.
+
+    Every value is converted with a static_cast, so values
+    must fit within the new value type.
+
+    @param grid
+    The grid to copy.
+
+    @returns a grid of equal deminsions, holding the
+    converted values.
+ */
+template <typename K, typename F>
+  FlexGrid<K> convertGrid(const FlexGrid<F>& grid) {
+    FlexGrid<K> r(grid.getWidth(), grid.getHeight());
+    for (unsigned int y = 0; y < grid.getHeight(); ++y) {
+      const F* in = grid.row(y);
+      K* out = r.row(y);
+      for (unsigned int x = 0; x < grid.getWidth(); ++x) {
+        out[x] = static_cast<K>(in[x]);
+      }
+    }
+    return r;
+  }
@@ -0,0 +1,93 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "MappedFile.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <stdexcept>
+
+/** Construct a new MappedFile object.
+
+    Maps the entire file at the provided path into memory,
+    read only. The file's pages are only read from disk
+    as they are first accessed.
+
+    @param path
+    The file to map.
+ */
+MappedFile::MappedFile(const std::string& path) : data(nullptr), size(0) {
+  const int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::runtime_error("Unable to open " + path + "!");
+  }
+
+  struct stat info;
+  if (fstat(fd, &info) != 0) {
+    close(fd);
+    throw std::runtime_error("Unable to read " + path + "!");
+  }
+  size = info.st_size;
+
+  // Empty files can not be mapped, but are still valid
+  if (size > 0) {
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+      close(fd);
+      throw std::runtime_error("Unable to map " + path + "!");
+    }
+    // The file is read front to back
+    madvise(mapped, size, MADV_SEQUENTIAL);
+    data = static_cast<const char*>(mapped);
+  }
+
+  // The mapping remains valid after the descriptor is closed
+  close(fd);
+}
+
+/** Destroys the MappedFile object, unmapping the file.
+ */
+MappedFile::~MappedFile() {
+  if (data) {
+    munmap(const_cast<char*>(data), size);
+  }
+}
+
+/** Retrieves the first byte of the file.
+
+    @returns a pointer to the first byte.
+ */
+const char* MappedFile::begin() const {
+  return data;
+}
+
+/** Retrieves the end of the file.
+
+    @returns a pointer one past the last byte.
+ */
+const char* MappedFile::end() const {
+  return data + size;
+}
+
+/** Gets the size of the file.
+
+    @returns the number of bytes in the file.
+ */
+std::size_t MappedFile::len() const {
+  return size;
+}
@@ -0,0 +1,36 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+
+#include <cstddef>
+#include <string>
+
+class MappedFile {
+  const char* data;
+  std::size_t size;
+public:
+  explicit MappedFile(const std::string&);
+  MappedFile(const MappedFile&) = delete;
+  ~MappedFile();
+
+  MappedFile& operator = (const MappedFile&) = delete;
+
+  const char* begin() const;
+  const char* end() const;
+  std::size_t len() const;
+};
+#endif
@@ -0,0 +1,473 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "Profiler.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+const char* const PHASE_NAMES[] = {"load", "export", "energy", "cost", "traceback", "removal", "seam"};
+const unsigned int PHASE_COUNT = sizeof(PHASE_NAMES) / sizeof(PHASE_NAMES[0]);
+
+// The most events kept per thread, and for exited threads
+const std::size_t EVENT_CAPACITY = 1 << 18;
+
+struct ProfileEvent {
+  Phase phase;
+  unsigned int thread;
+  Clock::time_point start;
+  Clock::time_point end;
+  std::size_t bytes;
+  std::size_t allocs;
+  std::size_t allocated;
+  std::size_t seam;
+  std::size_t seams;
+};
+
+struct PhaseTotals {
+  std::size_t calls;
+  double total;
+  double longest;
+  double bytes;
+  std::size_t allocs;
+  double allocated;
+};
+
+/** Keeps the most recent events, dropping the oldest once full.
+ */
+class EventRing {
+  std::vector<ProfileEvent> events;
+  std::size_t next;
+  std::size_t dropped;
+public:
+  EventRing() : next(0), dropped(0) { }
+
+  /** Adds an event, overwriting the oldest event once full.
+
+      @param event
+      The event to add.
+   */
+  void push(const ProfileEvent& event) {
+    if (events.size() < EVENT_CAPACITY) {
+      events.push_back(event);
+      return;
+    }
+    events[next] = event;
+    next = (next + 1) % EVENT_CAPACITY;
+    ++dropped;
+  }
+
+  /** Adds every held event to another ring, oldest first.
+
+      @param ring
+      The ring to add to, which also counts the events
+      this ring dropped.
+   */
+  void moveTo(EventRing& ring) const {
+    for (std::size_t i = 0; i < events.size(); ++i) {
+      ring.push(events[(next + i) % events.size()]);
+    }
+    ring.dropped += dropped;
+  }
+
+  /** Adds every held event to a list.
+
+      @param out
+      The list to add to.
+
+      @returns the number of events dropped.
+   */
+  std::size_t copyTo(std::vector<ProfileEvent>& out) const {
+    out.insert(out.end(), events.begin(), events.end());
+    return dropped;
+  }
+};
+
+/** Everything recorded by a single thread.
+
+    Only ever written by its own thread, so recording a phase
+    takes no lock. Registers itself for the summary and trace
+    when its thread first records, and hands its totals and
+    events over when its thread exits.
+ */
+struct ThreadRecord {
+  unsigned int thread;
+  std::size_t allocations;
+  std::size_t allocated;
+  PhaseTotals totals[PHASE_COUNT];
+  EventRing events;
+
+  ThreadRecord();
+  ~ThreadRecord();
+};
+
+std::mutex lock;
+std::vector<ThreadRecord*> live;
+PhaseTotals retired[PHASE_COUNT];
+EventRing retiredEvents;
+unsigned int threadCount = 0;
+Clock::time_point enabledAt;
+
+/** Adds the totals of one phase to another.
+
+    @param into
+    The totals to add to.
+
+    @param from
+    The totals to add.
+ */
+void addTotals(PhaseTotals& into, const PhaseTotals& from) {
+  into.calls += from.calls;
+  into.total += from.total;
+  into.longest = std::max(into.longest, from.longest);
+  into.bytes += from.bytes;
+  into.allocs += from.allocs;
+  into.allocated += from.allocated;
+}
+
+/** Construct a new ThreadRecord object, numbering its thread.
+ */
+ThreadRecord::ThreadRecord() : allocations(0), allocated(0), totals() {
+  std::lock_guard<std::mutex> guard(lock);
+  thread = threadCount++;
+  live.push_back(this);
+}
+
+/** Destroys the ThreadRecord object, keeping what it recorded.
+ */
+ThreadRecord::~ThreadRecord() {
+  std::lock_guard<std::mutex> guard(lock);
+  for (unsigned int p = 0; p < PHASE_COUNT; ++p) {
+    addTotals(retired[p], totals[p]);
+  }
+  events.moveTo(retiredEvents);
+  live.erase(std::find(live.begin(), live.end(), this));
+}
+
+/** Gets the record of the calling thread.
+
+    @returns the record, created on the thread's first call.
+ */
+ThreadRecord& threadRecord() {
+  thread_local ThreadRecord record;
+  return record;
+}
+
+/** Measures the time between two points in microseconds.
+
+    @param from
+    The earlier point.
+
+    @param to
+    The later point.
+
+    @returns the elapsed microseconds.
+ */
+double micros(const Clock::time_point& from, const Clock::time_point& to) {
+  return std::chrono::duration<double, std::micro>(to - from).count();
+}
+
+}
+
+std::atomic<bool> Profiler::active(false);
+std::atomic<bool> Profiler::tracing(false);
+
+/** Starts recording every profiled phase.
+
+    Phases are recorded from every thread, until the
+    program exits. Until enabled, every ProfileScope
+    costs a single relaxed load. Every thread adds its
+    phases to its own totals, without locking, so the
+    memory used stays constant, unless tracing, where
+    each thread also keeps its most recent events.
+
+    @param trace
+    Whether to keep every event for exportTrace, rather
+    than only the totals for writeSummary.
+ */
+void Profiler::enable(bool trace) {
+  std::lock_guard<std::mutex> guard(lock);
+  enabledAt = Clock::now();
+  tracing.store(trace, std::memory_order_relaxed);
+  active.store(true, std::memory_order_relaxed);
+}
+
+/** Checks whether phases are being recorded.
+
+    @returns true once enabled.
+ */
+bool Profiler::isEnabled() {
+  return active.load(std::memory_order_relaxed);
+}
+
+/** Counts an allocation of grid memory, while enabled.
+
+    Allocations are counted per thread, so a phase is only
+    charged for the allocations of its own thread.
+
+    @param bytes
+    The number of bytes allocated.
+ */
+void Profiler::countAllocation(std::size_t bytes) {
+  if (isEnabled()) {
+    ThreadRecord& record = threadRecord();
+    ++record.allocations;
+    record.allocated += bytes;
+  }
+}
+
+/** Gets the number of allocations counted so far.
+
+    @returns the number of allocations, on the calling thread.
+ */
+std::size_t Profiler::getAllocations() {
+  return threadRecord().allocations;
+}
+
+/** Gets the number of bytes allocated so far.
+
+    @returns the number of bytes, on the calling thread.
+ */
+std::size_t Profiler::getAllocated() {
+  return threadRecord().allocated;
+}
+
+/** Records a phase which has just ended on the calling thread.
+
+    @param phase
+    The phase.
+
+    @param start
+    When the phase started.
+
+    @param bytes
+    The number of bytes of grid data the phase read or wrote.
+
+    @param allocs
+    The number of allocations made during the phase.
+
+    @param allocated
+    The number of bytes allocated during the phase.
+
+    @param seam
+    The index of the seam the phase removed, counted by its engine.
+
+    @param seams
+    The number of seams the phase removed, from the indexed seam on.
+ */
+void Profiler::record(const Phase& phase, const Clock::time_point& start, std::size_t bytes,
+                      std::size_t allocs, std::size_t allocated, std::size_t seam, std::size_t seams) {
+  const Clock::time_point end = Clock::now();
+  const double us = micros(start, end);
+  ThreadRecord& record = threadRecord();
+
+  PhaseTotals& totals = record.totals[static_cast<unsigned int>(phase)];
+  // Seams removed in batches are counted individually
+  totals.calls += phase == Phase::SEAM ? seams : 1;
+  totals.total += us;
+  totals.longest = std::max(totals.longest, us);
+  totals.bytes += bytes;
+  totals.allocs += allocs;
+  totals.allocated += allocated;
+
+  if (tracing.load(std::memory_order_relaxed)) {
+    record.events.push({phase, record.thread, start, end, bytes, allocs, allocated, seam, seams});
+  }
+}
+
+/** Writes a table summarizing every recorded phase.
+
+    Lists the number of times each phase ran, counting every
+    seam of a batch, its total, mean and longest wall time, the grid data it touched,
+    and the allocations made during it. Phases nest within
+    seams, so the seam row repeats the time of the phases
+    within it, and phases running on several threads at
+    once may add up to more than the wall time. Must only
+    be called once carving has finished on every thread.
+
+    @param out
+    The stream to write to.
+ */
+void Profiler::writeSummary(std::ostream& out) {
+  std::lock_guard<std::mutex> guard(lock);
+
+  PhaseTotals totals[PHASE_COUNT] = {};
+  for (unsigned int p = 0; p < PHASE_COUNT; ++p) {
+    addTotals(totals[p], retired[p]);
+    for (const ThreadRecord* record : live) {
+      addTotals(totals[p], record->totals[p]);
+    }
+  }
+
+  const double MIB = 1024.0 * 1024.0;
+  out << std::fixed << std::setprecision(2)
+      << "phase      |    calls |   total ms |    mean us |     max us | touched MiB |    GiB/s |   allocs | alloc MiB\n"
+      << "-----------+----------+------------+------------+------------+-------------+----------+----------+----------\n";
+  for (unsigned int p = 0; p < PHASE_COUNT; ++p) {
+    const PhaseTotals& t = totals[p];
+    if (t.calls == 0) {
+      continue;
+    }
+    const double rate = t.total > 0 ? t.bytes / (t.total * 1e-6) / (1024 * MIB) : 0;
+    out << std::left << std::setw(10) << PHASE_NAMES[p] << std::right
+        << " | " << std::setw(8) << t.calls
+        << " | " << std::setw(10) << t.total / 1000
+        << " | " << std::setw(10) << t.total / t.calls
+        << " | " << std::setw(10) << t.longest
+        << " | " << std::setw(11) << t.bytes / MIB
+        << " | " << std::setw(8) << rate
+        << " | " << std::setw(8) << t.allocs
+        << " | " << std::setw(9) << t.allocated / MIB << "\n";
+  }
+  out << "wall " << micros(enabledAt, Clock::now()) / 1000 << " ms, " << threadCount << " threads\n";
+}
+
+/** Exports every recorded phase as a Chrome trace.
+
+    Every phase becomes a complete event, on the track of the
+    thread it ran on, carrying the grid data it touched and the
+    allocations made during it. Seams carry their index, as
+    counted by the engine which removed them, and the number
+    of seams removed, which is more than one for batches of
+    seams. Only the most recent events of
+    every thread are kept, with the number dropped written as
+    "dropped_events". The file may be opened in chrome://tracing,
+    or any viewer of the trace event format. Must only be called
+    once carving has finished on every thread.
+
+    @param path
+    The path of the file to create.
+ */
+void Profiler::exportTrace(const std::string& path) {
+  std::ofstream out(path);
+  if (!out) {
+    throw std::runtime_error("Unable to open " + path + " for writing!");
+  }
+
+  std::vector<ProfileEvent> events;
+  std::size_t dropped;
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    dropped = retiredEvents.copyTo(events);
+    for (const ThreadRecord* record : live) {
+      dropped += record->events.copyTo(events);
+    }
+  }
+  std::sort(events.begin(), events.end(), [](const ProfileEvent& a, const ProfileEvent& b) {
+    return a.end < b.end;
+  });
+
+  out << "{\"displayTimeUnit\": \"ms\", \"otherData\": {\"dropped_events\": " << dropped << "}"
+      << ", \"traceEvents\": [\n" << std::fixed << std::setprecision(3);
+  for (std::size_t i = 0; i < events.size(); ++i) {
+    const ProfileEvent& e = events[i];
+    out << "  {\"name\": \"" << PHASE_NAMES[static_cast<unsigned int>(e.phase)] << "\""
+        << ", \"ph\": \"X\", \"pid\": 1, \"tid\": " << e.thread
+        << ", \"ts\": " << micros(enabledAt, e.start)
+        << ", \"dur\": " << micros(e.start, e.end)
+        << ", \"args\": {\"bytes\": " << e.bytes
+        << ", \"allocs\": " << e.allocs
+        << ", \"alloc_bytes\": " << e.allocated;
+    if (e.phase == Phase::SEAM) {
+      out << ", \"seam\": " << e.seam << ", \"seams\": " << e.seams;
+    }
+    out << "}}" << (i + 1 < events.size() ? ",\n" : "\n");
+  }
+  out << "]}\n";
+
+  if (!out) {
+    throw std::runtime_error("Unable to write to file!");
+  }
+}
+
+/** Construct a new ProfileScope object.
+
+    Starts timing a phase, which is recorded once the scope
+    ends, but only while the Profiler is enabled.
+
+    @param phase
+    The phase being timed.
+
+    @param bytes
+    The number of bytes of grid data the phase reads or
+    writes, if known upfront.
+ */
+ProfileScope::ProfileScope(const Phase& phase, std::size_t bytes) : ProfileScope(phase, bytes, 0) { }
+
+/** Construct a new ProfileScope object, for the removal of a seam.
+
+    Starts timing a phase, which is recorded once the scope
+    ends, but only while the Profiler is enabled.
+
+    @param phase
+    The phase being timed.
+
+    @param bytes
+    The number of bytes of grid data the phase reads or
+    writes, if known upfront.
+
+    @param seam
+    The index of the seam being removed, as counted by
+    the engine removing it.
+ */
+ProfileScope::ProfileScope(const Phase& phase, std::size_t bytes, std::size_t seam) :
+  phase(phase), timing(Profiler::isEnabled()), bytes(bytes), allocs(0), allocated(0), seam(seam), seams(1) {
+  if (timing) {
+    allocs = Profiler::getAllocations();
+    allocated = Profiler::getAllocated();
+    started = std::chrono::steady_clock::now();
+  }
+}
+
+/** Destroys the ProfileScope object, recording its phase.
+ */
+ProfileScope::~ProfileScope() {
+  if (timing) {
+    Profiler::record(phase, started, bytes, Profiler::getAllocations() - allocs,
+                     Profiler::getAllocated() - allocated, seam, seams);
+  }
+}
+
+/** Adds to the grid data the phase reads or writes.
+
+    For phases which only learn how much data they touch
+    as they run.
+
+    @param bytes
+    The number of bytes to add.
+ */
+void ProfileScope::addBytes(std::size_t bytes) {
+  this->bytes += bytes;
+}
+
+/** Sets the number of seams the phase removes.
+
+    For batches of seams, which only learn how many seams
+    they remove as they run.
+
+    @param seams
+    The number of seams, from the scope's seam on.
+ */
+void ProfileScope::setSeams(std::size_t seams) {
+  this->seams = seams;
+}
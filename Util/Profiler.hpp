@@ -0,0 +1,73 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef PROFILER_HPP
+#define PROFILER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+enum class Phase {
+  LOAD,
+  EXPORT,
+  ENERGY,
+  COST,
+  TRACEBACK,
+  REMOVAL,
+  SEAM
+};
+
+class Profiler {
+  static std::atomic<bool> active;
+  static std::atomic<bool> tracing;
+public:
+  static void enable(bool);
+  static bool isEnabled();
+
+  static void countAllocation(std::size_t);
+  static std::size_t getAllocations();
+  static std::size_t getAllocated();
+
+  static void record(const Phase&, const std::chrono::steady_clock::time_point&, std::size_t,
+                     std::size_t, std::size_t, std::size_t, std::size_t);
+
+  static void writeSummary(std::ostream&);
+  static void exportTrace(const std::string&);
+};
+
+class ProfileScope {
+  Phase phase;
+  bool timing;
+  std::size_t bytes;
+  std::size_t allocs;
+  std::size_t allocated;
+  std::size_t seam;
+  std::size_t seams;
+  std::chrono::steady_clock::time_point started;
+public:
+  ProfileScope(const Phase&, std::size_t);
+  ProfileScope(const Phase&, std::size_t, std::size_t);
+  ProfileScope(const ProfileScope&) = delete;
+  ~ProfileScope();
+
+  ProfileScope& operator = (const ProfileScope&) = delete;
+
+  void addBytes(std::size_t);
+  void setSeams(std::size_t);
+};
+#endif
@@ -0,0 +1,137 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "RawFile.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <stdexcept>
+#include <vector>
+
+/** Construct a new RawFile object.
+
+    Opens a file for reading or writing at arbitrary offsets.
+    Files opened for writing are created if missing, and
+    truncated otherwise. Temporary files are created within
+    the provided directory, and removed as soon as they are
+    created, so that they vanish once closed, even if the
+    program does not exit cleanly.
+
+    @param path
+    The file to open, or the directory to create a
+    temporary file in.
+
+    @param access
+    How the file is used.
+ */
+RawFile::RawFile(const std::string& path, const FileAccess& access) : fd(-1) {
+  switch (access) {
+    case FileAccess::READ:
+      fd = open(path.c_str(), O_RDONLY);
+      break;
+    case FileAccess::WRITE:
+      fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+      break;
+    case FileAccess::TEMPORARY: {
+      const std::string pattern = path + "/SeamCarving.XXXXXX";
+      std::vector<char> name(pattern.begin(), pattern.end());
+      name.push_back('\0');
+      fd = mkstemp(name.data());
+      if (fd >= 0) {
+        unlink(name.data());
+      }
+      break;
+    }
+  }
+  if (fd < 0) {
+    throw std::runtime_error("Unable to open " + path + "!");
+  }
+}
+
+/** Destroys the RawFile object, closing the file.
+ */
+RawFile::~RawFile() {
+  close(fd);
+}
+
+/** Reads bytes from the file, stopping early at its end.
+
+    @param data
+    The memory to read into.
+
+    @param len
+    The number of bytes to read.
+
+    @param offset
+    The offset within the file to read from.
+
+    @returns the number of bytes read.
+ */
+std::size_t RawFile::readUpTo(void* data, std::size_t len, std::uint64_t offset) const {
+  char* out = static_cast<char*>(data);
+  std::size_t done = 0;
+  while (done < len) {
+    const ssize_t got = pread(fd, out + done, len - done, offset + done);
+    if (got < 0) {
+      throw std::runtime_error("Unable to read from file!");
+    }
+    if (got == 0) {
+      break;
+    }
+    done += got;
+  }
+  return done;
+}
+
+/** Reads bytes from the file.
+
+    @param data
+    The memory to read into.
+
+    @param len
+    The number of bytes to read, all of which must exist.
+
+    @param offset
+    The offset within the file to read from.
+ */
+void RawFile::read(void* data, std::size_t len, std::uint64_t offset) const {
+  if (readUpTo(data, len, offset) != len) {
+    throw std::runtime_error("Unexpected end of file!");
+  }
+}
+
+/** Writes bytes to the file, growing it as needed.
+
+    @param data
+    The bytes to write.
+
+    @param len
+    The number of bytes to write.
+
+    @param offset
+    The offset within the file to write to.
+ */
+void RawFile::write(const void* data, std::size_t len, std::uint64_t offset) {
+  const char* in = static_cast<const char*>(data);
+  std::size_t done = 0;
+  while (done < len) {
+    const ssize_t put = pwrite(fd, in + done, len - done, offset + done);
+    if (put <= 0) {
+      throw std::runtime_error("Unable to write to file!");
+    }
+    done += put;
+  }
+}
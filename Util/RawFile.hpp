@@ -0,0 +1,42 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef RAWFILE_HPP
+#define RAWFILE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+enum class FileAccess {
+  READ,
+  WRITE,
+  TEMPORARY
+};
+
+class RawFile {
+  int fd;
+public:
+  RawFile(const std::string&, const FileAccess&);
+  RawFile(const RawFile&) = delete;
+  ~RawFile();
+
+  RawFile& operator = (const RawFile&) = delete;
+
+  std::size_t readUpTo(void*, std::size_t, std::uint64_t) const;
+  void read(void*, std::size_t, std::uint64_t) const;
+  void write(const void*, std::size_t, std::uint64_t);
+};
+#endif
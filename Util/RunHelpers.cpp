@@ -0,0 +1,63 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "RunHelpers.hpp"
+
+/** Gets the number of seconds between two points in time.
+
+    @param from
+    The earlier point.
+
+    @param to
+    The later point.
+
+    @returns the elapsed seconds.
+ */
+double secsBetween(const std::chrono::steady_clock::time_point& from,
+                   const std::chrono::steady_clock::time_point& to) {
+  return std::chrono::duration<double>(to - from).count();
+}
+
+/** Checks whether a string ends with the provided suffix.
+
+    @param str
+    The string to check.
+
+    @param suffix
+    The suffix to look for.
+
+    @returns true if str ends with suffix.
+ */
+bool endsWith(const std::string& str, const std::string& suffix) {
+  return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/** Derives the default output name for an input file.
+
+    Mirrors the single image mode, replacing the ".pgm"
+    extension with "_processed.pgm". Shared by batch and
+    sequence modes.
+
+    @param input
+    The path of the input file.
+
+    @returns the path of the output file.
+ */
+std::string processedName(const std::string& input) {
+  const std::string ext = ".pgm";
+  const std::string base = endsWith(input, ext) ? input.substr(0, input.size() - ext.size()) : input;
+  return base + "_processed.pgm";
+}
@@ -0,0 +1,27 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef RUNHELPERS_HPP
+#define RUNHELPERS_HPP
+
+#include <chrono>
+#include <string>
+
+double secsBetween(const std::chrono::steady_clock::time_point&, const std::chrono::steady_clock::time_point&);
+
+bool endsWith(const std::string&, const std::string&);
+std::string processedName(const std::string&);
+#endif
@@ -0,0 +1,37 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef STRIDEDVIEW_HPP
+#define STRIDEDVIEW_HPP
+
+#include <cstddef>
+
+template <typename T>
+class StridedView {
+  T* first;
+  std::size_t length;
+  std::size_t step;
+public:
+  StridedView(T*, std::size_t, std::size_t);
+
+  T& operator [] (std::size_t) const;
+
+  std::size_t len() const;
+  std::size_t getStep() const;
+};
+
+#include "StridedView.ipp"
+
+#endif
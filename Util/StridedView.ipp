@@ -0,0 +1,68 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <cassert>
+
+/** Construct a new StridedView object.
+
+    Constructs a lightweight, non owning, view over
+    elements spaced a fixed number of elements apart.
+
+    @param first
+    The first element of the view.
+
+    @param length
+    The number of elements in the view.
+
+    @param step
+    The distance, in elements, between consecutive
+    elements of the view.
+ */
+template <typename T>
+  StridedView<T>::StridedView(T* first, std::size_t length, std::size_t step) :
+    first(first), length(length), step(step) { }
+
+/** Retrieves the element at the given view index.
+
+    The index is only bounds checked in debug builds.
+
+    @param i
+    The view index.
+
+    @returns a reference to the element.
+ */
+template <typename T>
+  T& StridedView<T>::operator [] (std::size_t i) const {
+    assert(i < length);
+    return first[i * step];
+  }
+
+/** Gets the number of elements in the view.
+
+    @returns the number of elements.
+ */
+template <typename T>
+  std::size_t StridedView<T>::len() const {
+    return length;
+  }
+
+/** Gets the distance between consecutive elements.
+
+    @returns the distance, in elements.
+ */
+template <typename T>
+  std::size_t StridedView<T>::getStep() const {
+    return step;
+  }
@@ -0,0 +1,149 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "ThreadPool.hpp"
+
+/** Construct a new ThreadPool object.
+
+    Constructs a new ThreadPool object, which runs tasks
+    on the requested number of threads. The thread calling
+    run is counted as one of these threads, so a pool of
+    size 1 runs every task serially, without spawning
+    any threads.
+
+    @param threads
+    The number of threads to run tasks on.
+ */
+ThreadPool::ThreadPool(unsigned int threads) :
+  job(nullptr), jobCount(0), nextTask(0), busy(0), generation(0), stopping(false) {
+  for (unsigned int i = 1; i < threads; ++i) {
+    workers.emplace_back(&ThreadPool::work, this);
+  }
+}
+
+/** Destroys the ThreadPool object, joining every worker thread.
+ */
+ThreadPool::~ThreadPool() {
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    stopping = true;
+  }
+  wake.notify_all();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+}
+
+/** Gets the number of threads tasks are run on.
+
+    @returns the number of threads, including the
+    thread calling run.
+ */
+unsigned int ThreadPool::size() const {
+  return workers.size() + 1;
+}
+
+/** Runs a batch of tasks, blocking until all have finished.
+
+    Every task index in [0, count) is handed to the provided
+    function exactly once, on whichever thread claims it
+    first. Returning only once every task has finished makes
+    each call a barrier. If a task throws, no further tasks
+    are started, and the first exception thrown is rethrown
+    once every running task has finished.
+
+    @param count
+    The number of tasks to run.
+
+    @param fn
+    The function to run for every task index.
+ */
+void ThreadPool::run(unsigned int count, const std::function<void(unsigned int)>& fn) {
+  if (workers.empty() || count < 2) {
+    for (unsigned int i = 0; i < count; ++i) {
+      fn(i);
+    }
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> guard(lock);
+    job = &fn;
+    jobCount = count;
+    nextTask = 0;
+    busy = workers.size();
+    ++generation;
+  }
+  wake.notify_all();
+
+  // Help out, rather than sitting idle
+  drain();
+
+  std::unique_lock<std::mutex> guard(lock);
+  done.wait(guard, [this] { return busy == 0; });
+  job = nullptr;
+  if (failure) {
+    std::exception_ptr thrown = failure;
+    failure = nullptr;
+    std::rethrow_exception(thrown);
+  }
+}
+
+/** The loop run by every worker thread.
+
+    Waits for a new batch of tasks, helps run it,
+    then reports back as finished.
+ */
+void ThreadPool::work() {
+  unsigned long seen = 0;
+  while (true) {
+    {
+      std::unique_lock<std::mutex> guard(lock);
+      wake.wait(guard, [this, seen] { return stopping || generation != seen; });
+      if (stopping) {
+        return;
+      }
+      seen = generation;
+    }
+
+    drain();
+
+    std::lock_guard<std::mutex> guard(lock);
+    if (--busy == 0) {
+      done.notify_one();
+    }
+  }
+}
+
+/** Runs tasks from the current batch until none are left.
+
+    Exceptions thrown by tasks are kept for run to rethrow,
+    rather than leaving the thread which ran them.
+ */
+void ThreadPool::drain() {
+  unsigned int task;
+  while ((task = nextTask++) < jobCount) {
+    try {
+      (*job)(task);
+    } catch (...) {
+      std::lock_guard<std::mutex> guard(lock);
+      if (!failure) {
+        failure = std::current_exception();
+      }
+      // Skip every task not yet started
+      nextTask = jobCount;
+    }
+  }
+}
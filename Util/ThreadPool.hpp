@@ -0,0 +1,56 @@
+// Copyright (C) 2015 Wyatt Childers
+//
+// This program is free software: you can redistribute it and/or modify
+// it under the terms of the GNU General Public License as published by
+// the Free Software Foundation, either version 3 of the License, or
+// (at your option) any later version.
+//
+// This program is distributed in the hope that it will be useful,
+// but WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+// GNU General Public License for more details.
+//
+// You should have received a copy of the GNU General Public License
+// along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool {
+  std::vector<std::thread> workers;
+
+  std::mutex lock;
+  std::condition_variable wake;
+  std::condition_variable done;
+
+  const std::function<void(unsigned int)>* job;
+  unsigned int jobCount;
+  std::atomic<unsigned int> nextTask;
+  std::exception_ptr failure;
+
+  unsigned int busy;
+  unsigned long generation;
+  bool stopping;
+public:
+  explicit ThreadPool(unsigned int);
+  ThreadPool(const ThreadPool&) = delete;
+  ~ThreadPool();
+
+  ThreadPool& operator = (const ThreadPool&) = delete;
+
+  unsigned int size() const;
+
+  void run(unsigned int, const std::function<void(unsigned int)>&);
+private:
+  void work();
+  void drain();
+};
+#endif
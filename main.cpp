@@ -13,39 +13,538 @@
 // You should have received a copy of the GNU General Public License
 // along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <regex>
 #include <string>
+#include <thread>
+#include <vector>
 
+#include "BatchRunner.hpp"
 #include "SeamCarver.hpp"
+#include "SeamIndex.hpp"
+#include "SequenceCarver.hpp"
+#include "StreamCarver.hpp"
 #include "ImageLoader.hpp"
+#include "RetargetEngine.hpp"
 #include "Util/FlexGrid.hpp"
+#include "Util/Profiler.hpp"
+#include "Util/ThreadPool.hpp"
+
+/** Writes out every phase recorded while profiling.
+
+    @param profile
+    The path of the Chrome trace file to write, "-" to print
+    a summary table to standard output instead, or an empty
+    string if not profiling.
+ */
+void writeProfile(const std::string& profile) {
+  if (profile == "-") {
+    Profiler::writeSummary(std::cout);
+  } else if (!profile.empty()) {
+    Profiler::exportTrace(profile);
+  }
+}
+
+/** Adds the pixels marked by a mask image to a mask.
+
+    A pixel marked by more than one mask image keeps the
+    cell it was first marked with.
+
+    @param path
+    The path of the mask image.
+
+    @param marked
+    The cell of every pixel the mask image marks.
+
+    @param image
+    The ImageLoader holding the image being masked.
+
+    @param mask
+    The mask to add to, which is sized to the image if empty.
+ */
+void addMask(const std::string& path, const MaskCell& marked, const ImageLoader& image,
+             FlexGrid<MaskCell>& mask) {
+  ImageLoader loader;
+  loader.loadFile(path);
+  if (loader.getWidth() != image.getWidth() || loader.getHeight() != image.getHeight()) {
+    throw std::runtime_error("Mask deminsions do not match the image!");
+  }
+
+  const FlexGrid<MaskCell> cells = loader.getMask(marked);
+  if (mask.getWidth() == 0) {
+    mask = cells;
+    return;
+  }
+  for (unsigned int h = 0; h < mask.getHeight(); ++h) {
+    for (unsigned int w = 0; w < mask.getWidth(); ++w) {
+      if (mask(w, h) == MaskCell::NONE) {
+        mask(w, h) = cells(w, h);
+      }
+    }
+  }
+}
+
+/** Checks whether a mask marks any pixel for removal.
+
+    @param mask
+    The mask to check.
+
+    @returns true if any cell is marked for removal.
+ */
+bool marksRemoval(const FlexGrid<MaskCell>& mask) {
+  for (unsigned int h = 0; h < mask.getHeight(); ++h) {
+    const MaskCell* cells = mask.row(h);
+    if (std::find(cells, cells + mask.getWidth(), MaskCell::REMOVE) != cells + mask.getWidth()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+/** Removes the requested seams from a loaded image.
+
+    Performs the removal of the vertical seams, followed by
+    the removal of the horizontal seams. Seams along the
+    direction of a seam index are removed using the index
+    instead. The carved pixel grid replaces the one stored
+    in the ImageLoader.
+
+    @param loader
+    The ImageLoader holding the image.
+
+    @param vert
+    The number of vertical seams to remove.
+
+    @param horiz
+    The number of horizontal seams to remove.
+
+    @param pool
+    The thread pool to split calculations across.
+
+    @param batch
+    The maximum number of seams to remove per cost grid.
+
+    @param useIndex
+    The path of a seam index file, or an empty string.
+
+    @param levels
+    The number of coarser levels to search seams on,
+    0 searches the full resolution grid only.
+
+    @param order
+    How the order of vertical and horizontal seam removals
+    is picked, other than removing vertical seams first.
+
+    @param energy
+    The energy function to carve with, every function other
+    than the gradient carving without any other option.
+
+    @param mask
+    The mask of the image, or an empty mask. Once a mask marking
+    pixels for removal has had all of them removed, no further
+    seams are removed.
+ */
+template <typename P>
+  void carveImage(ImageLoader& loader, unsigned int vert, unsigned int horiz, ThreadPool& pool,
+                  unsigned int batch, const std::string& useIndex, unsigned int levels,
+                  const SeamOrder& order, const EnergyKind& energy, const FlexGrid<MaskCell>& mask) {
+    const SearchMode search = levels > 0 ? SearchMode::PYRAMID : SearchMode::FULL;
+    FlexGrid<P> f = loader.getGrid<P>();
+    if (energy != EnergyKind::GRADIENT) {
+      FlexGrid<P> p = seamCarve(f, CarvingMode::VERTICAL, vert, pool, energy);
+      f = seamCarve(p, CarvingMode::HORIZONTAL, horiz, pool, energy);
+    } else if (mask.getWidth() > 0) {
+      FlexGrid<MaskCell> m = mask;
+      const bool removing = marksRemoval(m);
+      f = seamCarve(f, CarvingMode::VERTICAL, vert, pool, batch, m);
+      if (!removing || marksRemoval(m)) {
+        f = seamCarve(f, CarvingMode::HORIZONTAL, horiz, pool, batch, m);
+      }
+    } else if (order != SeamOrder::VERTICAL_FIRST) {
+      f = retarget(f, f.getWidth() - std::min(vert, f.getWidth()), f.getHeight() - std::min(horiz, f.getHeight()),
+                   order, pool);
+    } else if (!useIndex.empty()) {
+      SeamIndex index;
+      index.loadFile(useIndex);
+      if (index.getMode() == CarvingMode::VERTICAL) {
+        f = index.retarget(f, f.getWidth() - std::min(vert, f.getWidth()));
+        f = seamCarve(f, CarvingMode::HORIZONTAL, horiz, pool, batch, search, levels);
+      } else {
+        f = index.retarget(f, f.getHeight() - std::min(horiz, f.getHeight()));
+        f = seamCarve(f, CarvingMode::VERTICAL, vert, pool, batch, search, levels);
+      }
+    } else {
+      FlexGrid<P> p = seamCarve(f, CarvingMode::VERTICAL, vert, pool, batch, search, levels);
+      f = seamCarve(p, CarvingMode::HORIZONTAL, horiz, pool, batch, search, levels);
+    }
+    loader.setGrid(f);
+  }
+
+/** Inserts the requested seams into a loaded image.
+
+    Performs the insertion of the vertical seams, followed by
+    the insertion of the horizontal seams. The enlarged pixel
+    grid replaces the one stored in the ImageLoader.
+
+    @param loader
+    The ImageLoader holding the image.
+
+    @param vert
+    The number of vertical seams to insert.
+
+    @param horiz
+    The number of horizontal seams to insert.
+
+    @param pool
+    The thread pool to split calculations across.
+
+    @param batch
+    The maximum number of seams to remove per cost grid
+    while finding the seams to insert.
+ */
+template <typename P>
+  void enlargeImage(ImageLoader& loader, unsigned int vert, unsigned int horiz, ThreadPool& pool,
+                    unsigned int batch) {
+    FlexGrid<P> p = seamInsert(loader.getGrid<P>(), CarvingMode::VERTICAL, vert, pool, batch);
+    loader.setGrid(seamInsert(p, CarvingMode::HORIZONTAL, horiz, pool, batch));
+  }
 
 int main(int argc, char* argv[]) {
+  // Separate the optional flags from the positional arguments
+  std::vector<std::string> args;
+  unsigned int threads = 1;
+  unsigned int batch = 1;
+  unsigned int jobs = 1;
+  unsigned int levels = 0;
+  SeamOrder order = SeamOrder::VERTICAL_FIRST;
+  bool enlarge = false;
+  EnergyKind energy = EnergyKind::GRADIENT;
+  std::string format;
+  std::string manifest;
+  std::string pattern;
+  std::string buildIndex;
+  std::string useIndex;
+  std::size_t streamBudget = 0;
+  std::string tmpDir = "/tmp";
+  std::string sequence;
+  unsigned int window = 4;
+  std::string protect;
+  std::string remove;
+  std::string profile;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (arg == "-t" || arg == "--threads") {
+      if (++i >= argc) {
+        throw std::runtime_error("Missing thread count!");
+      }
+      // A thread count of 0 uses every available core
+      threads = std::atoi(argv[i]);
+      if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+      }
+    } else if (arg == "-b" || arg == "--batch") {
+      if (++i >= argc) {
+        throw std::runtime_error("Missing batch size!");
+      }
+      batch = std::max(1, std::atoi(argv[i]));
+    } else if (arg == "-p" || arg == "--pyramid") {
+      if (++i >= argc) {
+        throw std::runtime_error("Missing pyramid level count!");
+      }
+      levels = std::max(0, std::atoi(argv[i]));
+    } else if (arg == "-o" || arg == "--order") {
+      if (++i >= argc) {
+        throw std::runtime_error("Missing seam order!");
+      }
+      const std::string name = argv[i];
+      if (name == "vertical") {
+        order = SeamOrder::VERTICAL_FIRST;
+      } else if (name == "greedy") {
+        order = SeamOrder::GREEDY;
+      } else if (name == "optimal") {
+        order = SeamOrder::OPTIMAL;
+      } else {
+        throw std::runtime_error("Seam order must be vertical, greedy or optimal!");
+      }
+    } else if (arg == "-E" || arg == "--energy") {
+      if (++i >= argc) {
+        throw std::runtime_error("Missing energy function!");
+      }
+      const std::string name = argv[i];
+      if (name == "gradient") {
+        energy = EnergyKind::GRADIENT;
+      } else if (name == "sobel") {
+        energy = EnergyKind::SOBEL;
+      } else if (name == "forward") {
+        energy = EnergyKind::FORWARD;
+      } else {
+        throw std::runtime_error("Energy function must be gradient, sobel or forward!");
+      }
+    } else if (arg == "-e" || arg == "--enlarge") {
+      enlarge = true;
+    } else if (arg == "-j" || arg == "--jobs") {
+      if (++i >= argc) {
+        throw std::runtime_error("Missing job count!");
+      }
+      // A job count of 0 carves one image per available core
+      jobs = std::atoi(argv[i]);
+      if (jobs == 0) {
+        jobs = std::max(1u, std::thread::hardware_concurrency());
+      }
+    } else if (arg == "-m" || arg == "--manifest") {
+      if (++i >= argc) {
+        throw std::runtime_error("Missing manifest file!");
+      }
+      manifest = argv[i];
+    } else if (arg == "-g" || arg == "--glob") {
+      if (++i >= argc) {
+        throw std::runtime_error("Missing glob pattern!");
+      }
+      pattern = argv[i];
+    } else if (arg == "--build-index") {
+      if (++i >= argc) {
+        throw std::runtime_error("Missing seam index file!");
+      }
+      buildIndex = argv[i];
+    } else if (arg == "-i" || arg == "--index") {
+      if (++i >= argc) {
+        throw std::runtime_error("Missing seam index file!");
+      }
+      useIndex = argv[i];
+    } else if (arg == "-s" || arg == "--stream") {
+      if (++i >= argc) {
+        throw std::runtime_error("Missing memory budget!");
+      }
+      // The budget is given in MiB
+      streamBudget = static_cast<std::size_t>(std::max(1, std::atoi(argv[i]))) << 20;
+    } else if (arg == "--tmp") {
+      if (++i >= argc) {
+        throw std::runtime_error("Missing scratch directory!");
+      }
+      tmpDir = argv[i];
+    } else if (arg == "-q" || arg == "--sequence") {
+      if (++i >= argc) {
+        throw std::runtime_error("Missing frame list or stream!");
+      }
+      sequence = argv[i];
+    } else if (arg == "-w" || arg == "--window") {
+      if (++i >= argc) {
+        throw std::runtime_error("Missing seam window!");
+      }
+      window = std::max(0, std::atoi(argv[i]));
+    } else if (arg == "--protect") {
+      if (++i >= argc) {
+        throw std::runtime_error("Missing protection mask!");
+      }
+      protect = argv[i];
+    } else if (arg == "--remove") {
+      if (++i >= argc) {
+        throw std::runtime_error("Missing removal mask!");
+      }
+      remove = argv[i];
+    } else if (arg == "--profile") {
+      if (++i >= argc) {
+        throw std::runtime_error("Missing profile file!");
+      }
+      profile = argv[i];
+    } else if (arg == "-f" || arg == "--format") {
+      if (++i >= argc) {
+        throw std::runtime_error("Missing output format!");
+      }
+      format = argv[i];
+      if (format != "p2" && format != "p5") {
+        throw std::runtime_error("Output format must be p2 or p5!");
+      }
+    } else {
+      args.push_back(arg);
+    }
+  }
+
+  if (!profile.empty()) {
+    Profiler::enable(profile != "-");
+  }
+
+  const bool masked = !protect.empty() || !remove.empty();
+  if (energy != EnergyKind::GRADIENT &&
+      (!manifest.empty() || !pattern.empty() || !sequence.empty() || streamBudget > 0 || enlarge ||
+       !buildIndex.empty() || !useIndex.empty() || levels > 0 || order != SeamOrder::VERTICAL_FIRST || masked)) {
+    throw std::runtime_error("Sobel and forward energies cannot be combined with other carving options!");
+  }
+  if (masked &&
+      (!manifest.empty() || !pattern.empty() || !sequence.empty() || streamBudget > 0 || enlarge ||
+       !buildIndex.empty() || !useIndex.empty() || levels > 0 || order != SeamOrder::VERTICAL_FIRST)) {
+    throw std::runtime_error("Masks cannot be combined with other carving options!");
+  }
+
+  // Batch and sequence modes carve every image in full, without
+  // any of the single image options
+  const bool batched = !manifest.empty() || !pattern.empty();
+  if ((batched || !sequence.empty()) && (!buildIndex.empty() || !useIndex.empty())) {
+    throw std::runtime_error("Seam indices cannot be used in batch or sequence mode!");
+  }
+  if ((batched || !sequence.empty()) && streamBudget > 0) {
+    throw std::runtime_error("Streaming cannot be used in batch or sequence mode!");
+  }
+  if ((batched || !sequence.empty()) && levels > 0) {
+    throw std::runtime_error("Pyramid searches cannot be used in batch or sequence mode!");
+  }
+  if ((batched || !sequence.empty()) && order != SeamOrder::VERTICAL_FIRST) {
+    throw std::runtime_error("Seam orders cannot be used in batch or sequence mode!");
+  }
+  if ((batched || !sequence.empty()) && enlarge) {
+    throw std::runtime_error("Enlarging cannot be used in batch or sequence mode!");
+  }
+  if (!sequence.empty() && (batched || batch > 1)) {
+    throw std::runtime_error("Sequences cannot be combined with batches!");
+  }
+
+  // Carve every image of a manifest, or every image matching a
+  // glob pattern, using a pool of workers
+  if (batched) {
+    BatchRunner runner(jobs, threads, batch);
+    if (!format.empty()) {
+      runner.setFormat(format == "p2" ? PgmFormat::ASCII : PgmFormat::BINARY);
+    }
+    if (!manifest.empty()) {
+      if (!args.empty()) {
+        throw std::runtime_error("Illegal number of arguments!");
+      }
+      runner.loadManifest(manifest);
+    }
+    if (!pattern.empty()) {
+      // The seams to remove from every matching image
+      // are given as the positional arguments
+      if (args.size() != 2) {
+        throw std::runtime_error("Illegal number of arguments!");
+      }
+      runner.addGlob(pattern, std::atoi(args[0].c_str()), std::atoi(args[1].c_str()));
+    }
+    const bool ok = runner.run(std::cout);
+    writeProfile(profile);
+    return ok ? 0 : 1;
+  }
+
+  // Carve the frames of a video in order, each following the
+  // seams of the frame before it
+  if (!sequence.empty()) {
+    if (args.size() != 2) {
+      throw std::runtime_error("Illegal number of arguments!");
+    }
+    SequenceCarver carver(threads, window);
+    if (!format.empty()) {
+      carver.setFormat(format == "p2" ? PgmFormat::ASCII : PgmFormat::BINARY);
+    }
+    // A ".pgm" file is a multi-image stream, anything
+    // else lists one frame per line
+    const std::regex stream("(\\.pgm)$");
+    if (std::regex_search(sequence, stream)) {
+      carver.setStream(sequence, std::regex_replace(sequence, stream, "") + "_processed.pgm");
+    } else {
+      carver.loadList(sequence);
+    }
+    const bool ok = carver.run(std::atoi(args[0].c_str()), std::atoi(args[1].c_str()), std::cout);
+    writeProfile(profile);
+    return ok ? 0 : 1;
+  }
+
   // Check that the proper amount of arguments have
   // been supplied
-  if (argc == 4) {
+  if (args.size() == 3) {
     // Remove the file name from the file extension
-    std::string file = std::regex_replace(argv[1], std::regex("(\\.pgm)"), "");
+    std::string file = std::regex_replace(args[0], std::regex("(\\.pgm)"), "");
     // Get the number of vertical seams to remove
-    unsigned int vert = std::atoi(argv[2]);
+    unsigned int vert = std::atoi(args[1].c_str());
     // Get the number of horizontal seams to remove
-    unsigned int horiz = std::atoi(argv[3]);
+    unsigned int horiz = std::atoi(args[2].c_str());
+
+    ThreadPool pool(threads);
+
+    if (enlarge && (streamBudget > 0 || !buildIndex.empty() || !useIndex.empty() || levels > 0 ||
+                    order != SeamOrder::VERTICAL_FIRST)) {
+      throw std::runtime_error("Enlarging cannot be combined with other carving options!");
+    }
+
+    // Carve images too large to hold in memory a strip
+    // of rows at a time, within a memory budget
+    if (streamBudget > 0) {
+      if (!buildIndex.empty() || !useIndex.empty()) {
+        throw std::runtime_error("Seam indices cannot be used while streaming!");
+      }
+      if (order != SeamOrder::VERTICAL_FIRST) {
+        throw std::runtime_error("Seam orders cannot be used while streaming!");
+      }
+      if (levels > 0) {
+        throw std::runtime_error("Pyramid searches cannot be used while streaming!");
+      }
+      if (format == "p2") {
+        throw std::runtime_error("Streamed images are always exported as p5!");
+      }
+      StreamCarver carver(streamBudget, tmpDir, pool, batch);
+      carver.carveFile(file + ".pgm", file + "_processed.pgm", vert, horiz);
+      writeProfile(profile);
+      return 0;
+    }
 
     // Establish an ImageLoader, then load the file, with the removed
     // ".pgm" extension readded
     ImageLoader loader;
     loader.loadFile(file + ".pgm");
 
-    // Perform the removal of the vertical seams, followed by the
-    // removal of the horizontal seams
-    FlexGrid<int> p = seamCarve(loader.getGrid(), CarvingMode::VERTICAL, vert);
-    FlexGrid<int> f = seamCarve(p, CarvingMode::HORIZONTAL, horiz);
+    // Record the order seams are removed in, along one direction,
+    // so that the image may later be retargeted without carving
+    if (!buildIndex.empty()) {
+      if ((vert == 0) == (horiz == 0)) {
+        throw std::runtime_error("A seam index covers exactly one direction!");
+      }
+      const CarvingMode mode = vert > 0 ? CarvingMode::VERTICAL : CarvingMode::HORIZONTAL;
+      SeamIndex index;
+      if (loader.isWide()) {
+        index.build(loader.getGrid<std::uint16_t>(), mode, vert > 0 ? vert : horiz, pool, batch);
+      } else {
+        index.build(loader.getGrid<std::uint8_t>(), mode, vert > 0 ? vert : horiz, pool, batch);
+      }
+      index.exportFile(buildIndex);
+      writeProfile(profile);
+      return 0;
+    }
 
-    // Update the pixel grid stored in the ImageLoader,
-    // and export the file, as being processed
-    loader.setGrid(f);
+    if (order != SeamOrder::VERTICAL_FIRST && (!useIndex.empty() || levels > 0)) {
+      throw std::runtime_error("Seam orders cannot be combined with seam indices or pyramid searches!");
+    }
+
+    // Protected pixels are loaded first, so that they stay
+    // protected where the masks overlap
+    FlexGrid<MaskCell> mask(0, 0);
+    if (!protect.empty()) {
+      addMask(protect, MaskCell::PROTECT, loader, mask);
+    }
+    if (!remove.empty()) {
+      addMask(remove, MaskCell::REMOVE, loader, mask);
+    }
+
+    // Carve the pixels in the narrowest type able to hold them
+    if (enlarge) {
+      if (loader.isWide()) {
+        enlargeImage<std::uint16_t>(loader, vert, horiz, pool, batch);
+      } else {
+        enlargeImage<std::uint8_t>(loader, vert, horiz, pool, batch);
+      }
+    } else if (loader.isWide()) {
+      carveImage<std::uint16_t>(loader, vert, horiz, pool, batch, useIndex, levels, order, energy, mask);
+    } else {
+      carveImage<std::uint8_t>(loader, vert, horiz, pool, batch, useIndex, levels, order, energy, mask);
+    }
+
+    // Export the file, as being processed, in the requested
+    // format, or the format of the original file
+    if (!format.empty()) {
+      loader.setFormat(format == "p2" ? PgmFormat::ASCII : PgmFormat::BINARY);
+    }
     loader.exportFile(file + "_processed.pgm");
+    writeProfile(profile);
   } else {
     throw std::runtime_error("Illegal number of arguments!");
   }